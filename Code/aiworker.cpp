@@ -0,0 +1,47 @@
+#include "aiworker.h"
+
+#include <QCoreApplication>
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Жёсткий предел хода — пятисекундный таймер хода без запаса на доставку
+// хода в окно; обычно распорядитель времени заканчивает поиск много раньше.
+constexpr int kMoveTimeMs = 4500;
+
+MctsLimits workerLimits() {
+    MctsLimits limits;
+    limits.timeMs = kMoveTimeMs;
+    limits.threads = std::max(1u, std::thread::hardware_concurrency());
+    return limits;
+}
+
+} // namespace
+
+AIWorker::AIWorker()
+    : engine('O', workerLimits()) {
+    const QString dir = QCoreApplication::applicationDirPath();
+    book.open((dir + "/hexbook.bin").toStdString());
+    if (positions.open((dir + "/hexpositions.db").toStdString())) engine.setPositions(&positions);
+}
+
+void AIWorker::search(const HexGame& position, quint64 generation, const StopFlag& stop) {
+    if (stop->load()) return;
+    Move move = book.lookup(position);
+    if (!move.isValid()) {
+        SearchLimits limits;
+        limits.stop = stop.get();
+        engine.setAnalysis(analysisEnabled.load() ? &analysis : nullptr);
+        move = engine.think(position, limits);
+    }
+    if (stop->load()) return;
+    emit moveReady(generation, move.row, move.col);
+}
+
+void AIWorker::ponder(const HexGame& position, const StopFlag& stop) {
+    if (stop->load()) return;
+    engine.setStopFlag(stop.get());
+    engine.ponder(position);
+    engine.setStopFlag(nullptr);
+}
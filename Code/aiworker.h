@@ -0,0 +1,46 @@
+#ifndef AIWORKER_H
+#define AIWORKER_H
+
+#include <QObject>
+#include <atomic>
+#include <memory>
+
+#include "hexcore/mctsai.h"
+#include "hexcore/openingbook.h"
+#include "hexcore/positiondb.h"
+
+// Живёт в отдельном потоке: ищет ход на копии позиции и возвращает его
+// сигналом, который доходит до окна через очередь событий. В ход человека
+// движок размышляет над его ответами, и дерево переходит в следующий поиск.
+// Дебютные ходы берутся из hexbook.bin рядом с программой, если он есть,
+// а исходы сыгранных партий — из базы позиций hexpositions.db (hex_arena
+// --positions). Во время поиска, если окно включило анализ, движок
+// публикует снимки корня в буфер, который окно читает без блокировок.
+class AIWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    using StopFlag = std::shared_ptr<std::atomic<bool>>;
+
+    AIWorker();
+
+    void search(const HexGame& position, quint64 generation, const StopFlag& stop);
+    void ponder(const HexGame& position, const StopFlag& stop);
+
+    // Читает только поток окна; включение действует со следующего поиска.
+    AnalysisBuffer& analysisBuffer() { return analysis; }
+    void setAnalysisEnabled(bool enabled) { analysisEnabled.store(enabled); }
+
+signals:
+    void moveReady(quint64 generation, int row, int col);
+
+private:
+    MctsAI engine;
+    OpeningBook book;
+    PositionDB positions;
+    AnalysisBuffer analysis;
+    std::atomic<bool> analysisEnabled{false};
+};
+
+#endif // AIWORKER_H
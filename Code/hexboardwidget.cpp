@@ -0,0 +1,306 @@
+#include "hexboardwidget.h"
+
+#include <QLinearGradient>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kSqrt3 = std::sqrt(3.0);
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kFrame = 0.8;        // ширина рамки сторон в радиусах клетки
+constexpr double kGap = 2.0;          // зазор между клетками, пиксели
+constexpr double kPreferredRadius = 24.0;
+constexpr double kMinRadius = 8.0;
+constexpr int kAnalysisLevels = 32;
+
+const QColor kGridColor(0x33, 0x33, 0x33);
+const QColor kXColor(0xCC, 0x00, 0x00);
+const QColor kOColor(0x00, 0x55, 0xCC);
+
+// Размер ромба рамки при радиусе клетки radius.
+QSizeF boardExtent(int size, double radius) {
+    const double span = 1.5 * (size - 1);
+    return QSizeF(radius * (kSqrt3 * span + 6.0 * (1.0 + kFrame) / kSqrt3),
+                  radius * (span + 2.0 * (1.0 + kFrame)));
+}
+
+QPointF eventPoint(const QMouseEvent* event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position();
+#else
+    return event->localPos();
+#endif
+}
+
+} // namespace
+
+HexBoardWidget::HexBoardWidget(QWidget* parent)
+    : QWidget(parent) {
+    // Фон рисуется в paintEvent, иначе частичная перерисовка стирала бы соседей.
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(true);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void HexBoardWidget::setBoardSize(int size) {
+    boardSize = size;
+    cells.assign(size * size, '.');
+    isDirty.assign(size * size, false);
+    dirty.clear();
+    dirtyRegion = QRegion();
+    hovered = -1;
+    heatLevel.clear();
+    heatTone.clear();
+    pvStep.clear();
+    layoutBoard();
+    updateGeometry();
+    update();
+}
+
+void HexBoardWidget::setCell(int row, int col, char cell) {
+    if (row < 0 || row >= boardSize || col < 0 || col >= boardSize) return;
+    const int idx = row * boardSize + col;
+    if (cells[idx] == cell) return;
+    cells[idx] = cell;
+    markDirty(idx);
+}
+
+void HexBoardWidget::setAnalysis(const std::vector<float>& visitShare, const std::vector<float>& winRate,
+                                 const std::vector<int>& pv, char firstMover) {
+    const int total = boardSize * boardSize;
+    if (static_cast<int>(visitShare.size()) != total || static_cast<int>(winRate.size()) != total) return;
+    if (heatLevel.empty()) {
+        heatLevel.assign(total, 0);
+        heatTone.assign(total, 0);
+        pvStep.assign(total, 0);
+    }
+    std::vector<uint8_t> steps(total, 0);
+    for (size_t k = 0; k < pv.size(); ++k) {
+        if (pv[k] >= 0 && pv[k] < total && steps[pv[k]] == 0) steps[pv[k]] = static_cast<uint8_t>(k + 1);
+    }
+    const bool moverChanged = firstMover != pvFirst;
+    pvFirst = firstMover;
+    for (int idx = 0; idx < total; ++idx) {
+        const auto level = static_cast<uint8_t>(std::lround(std::clamp(visitShare[idx], 0.0f, 1.0f) * kAnalysisLevels));
+        const auto tone = static_cast<uint8_t>(std::lround(std::clamp(winRate[idx], 0.0f, 1.0f) * kAnalysisLevels));
+        if (level != heatLevel[idx] || tone != heatTone[idx] || steps[idx] != pvStep[idx] ||
+            (moverChanged && steps[idx] != 0)) {
+            heatLevel[idx] = level;
+            heatTone[idx] = tone;
+            pvStep[idx] = steps[idx];
+            markDirty(idx);
+        }
+    }
+}
+
+void HexBoardWidget::clearAnalysis() {
+    if (heatLevel.empty()) return;
+    for (int idx = 0; idx < boardSize * boardSize; ++idx) {
+        if (heatLevel[idx] != 0 || pvStep[idx] != 0) markDirty(idx);
+    }
+    heatLevel.clear();
+    heatTone.clear();
+    pvStep.clear();
+}
+
+QSize HexBoardWidget::sizeHint() const {
+    if (boardSize == 0) return QSize(400, 400);
+    // Крупные доски ужимаются, чтобы окно оставалось в пределах экрана.
+    const double unit = boardExtent(boardSize, 1.0).width();
+    return boardExtent(boardSize, std::clamp(640.0 / unit, kMinRadius, kPreferredRadius)).toSize();
+}
+
+QSize HexBoardWidget::minimumSizeHint() const {
+    if (boardSize == 0) return QSize(100, 100);
+    return boardExtent(boardSize, kMinRadius).toSize();
+}
+
+QPointF HexBoardWidget::cellCenter(int idx) const {
+    const int r = idx / boardSize;
+    const int c = idx % boardSize;
+    return origin + QPointF(kSqrt3 * radius * (c + r / 2.0), 1.5 * radius * r);
+}
+
+QPolygonF HexBoardWidget::hexagon(QPointF center, double extent) const {
+    QPolygonF poly;
+    for (int i = 0; i < 6; ++i) {
+        const double angle = (60.0 * i - 30.0) * kPi / 180.0;
+        poly << center + QPointF(extent * std::cos(angle), extent * std::sin(angle));
+    }
+    return poly;
+}
+
+int HexBoardWidget::cellAt(QPointF point) const {
+    if (boardSize == 0 || radius <= 0.0) return -1;
+    // Дробные осевые координаты округляются через кубические: так находится
+    // шестиугольник, внутри которого лежит точка.
+    const QPointF p = point - origin;
+    const double rf = p.y() / (1.5 * radius);
+    const double qf = p.x() / (kSqrt3 * radius) - rf / 2.0;
+    const double sf = -qf - rf;
+    double q = std::round(qf), r = std::round(rf), s = std::round(sf);
+    const double dq = std::abs(q - qf), dr = std::abs(r - rf), ds = std::abs(s - sf);
+    if (dq > dr && dq > ds) q = -r - s;
+    else if (dr > ds) r = -q - s;
+    const int row = static_cast<int>(r);
+    const int col = static_cast<int>(q);
+    if (row < 0 || row >= boardSize || col < 0 || col >= boardSize) return -1;
+    const int idx = row * boardSize + col;
+    // Щель между клетками — не клик.
+    if (!hexagon(cellCenter(idx), radius - kGap).containsPoint(point, Qt::OddEvenFill)) return -1;
+    return idx;
+}
+
+void HexBoardWidget::markDirty(int idx) {
+    if (idx < 0 || isDirty[idx]) return;
+    isDirty[idx] = true;
+    dirty.push_back(idx);
+    const QRegion area(hexagon(cellCenter(idx), radius).toPolygon());
+    dirtyRegion += area;
+    update(area);
+}
+
+void HexBoardWidget::setHovered(int idx) {
+    if (idx == hovered) return;
+    const int previous = hovered;
+    hovered = idx;
+    markDirty(previous);
+    markDirty(idx);
+}
+
+void HexBoardWidget::layoutBoard() {
+    if (boardSize == 0) return;
+    const QSizeF unit = boardExtent(boardSize, 1.0);
+    radius = std::max(1.0, std::min(width() / unit.width(), height() / unit.height()));
+    const double spanX = kSqrt3 * radius * 1.5 * (boardSize - 1);
+    const double spanY = 1.5 * radius * (boardSize - 1);
+    origin = QPointF((width() - spanX) / 2.0, (height() - spanY) / 2.0);
+}
+
+void HexBoardWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    // Перекрытое окно или новый размер требуют большего, чем грязные клетки.
+    if (!dirty.empty() && event->region().subtracted(dirtyRegion).isEmpty()) {
+        for (int idx : dirty) paintCell(painter, idx);
+    } else {
+        paintBoard(painter);
+    }
+    for (int idx : dirty) isDirty[idx] = false;
+    dirty.clear();
+    dirtyRegion = QRegion();
+}
+
+void HexBoardWidget::paintBoard(QPainter& painter) {
+    painter.fillRect(rect(), palette().window());
+    if (boardSize == 0) return;
+
+    // Рамка: стороны X слева и справа, стороны O сверху и снизу. Стороны
+    // ромба идут вдоль рядов и столбцов на kFrame радиуса дальше вершин
+    // крайних клеток; углы — их пересечения.
+    const int last = boardSize - 1;
+    const QPointF center = (cellCenter(0) + cellCenter(boardSize * boardSize - 1)) / 2.0;
+    const double k = 2.0 * (1.0 + kFrame) * radius / kSqrt3;
+    const QPointF alongRow(k, 0.0);
+    const QPointF alongColumn(k / 2.0, k * kSqrt3 / 2.0);
+    const QPointF topLeft = cellCenter(0) - alongRow - alongColumn;
+    const QPointF topRight = cellCenter(last) + alongRow - alongColumn;
+    const QPointF bottomLeft = cellCenter(last * boardSize) - alongRow + alongColumn;
+    const QPointF bottomRight = cellCenter(boardSize * boardSize - 1) + alongRow + alongColumn;
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(kOColor);
+    painter.drawPolygon(QPolygonF() << center << topLeft << topRight);
+    painter.drawPolygon(QPolygonF() << center << bottomLeft << bottomRight);
+    painter.setBrush(kXColor);
+    painter.drawPolygon(QPolygonF() << center << topLeft << bottomLeft);
+    painter.drawPolygon(QPolygonF() << center << topRight << bottomRight);
+
+    for (int idx = 0; idx < boardSize * boardSize; ++idx) paintCell(painter, idx);
+}
+
+void HexBoardWidget::paintCell(QPainter& painter, int idx) {
+    const QPointF center = cellCenter(idx);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(kGridColor);
+    painter.drawPolygon(hexagon(center, radius));
+
+    const char cell = cells[idx];
+    const QPolygonF shape = hexagon(center, radius - kGap);
+    QLinearGradient gradient(shape.boundingRect().topLeft(), shape.boundingRect().bottomRight());
+    QColor border;
+    if (cell == 'X') {
+        gradient.setColorAt(0, QColor("#FF8888"));
+        gradient.setColorAt(1, QColor("#CC0000"));
+        border = QColor("#FF4444");
+    } else if (cell == 'O') {
+        gradient.setColorAt(0, QColor("#88CCFF"));
+        gradient.setColorAt(1, QColor("#0055CC"));
+        border = QColor("#44AAFF");
+    } else if (idx == hovered) {
+        gradient.setColorAt(0, QColor("#EEEEEE"));
+        gradient.setColorAt(1, QColor("#CCCCCC"));
+        border = QColor("#777777");
+    } else {
+        gradient.setColorAt(0, QColor("#DDDDDD"));
+        gradient.setColorAt(1, QColor("#AAAAAA"));
+        border = QColor("#777777");
+    }
+    painter.setPen(QPen(border, 2.0));
+    painter.setBrush(gradient);
+    painter.drawPolygon(shape);
+
+    if (!heatLevel.empty() && cell == '.') paintAnalysis(painter, idx, shape);
+
+    if (cell == 'X' || cell == 'O') {
+        QFont font = painter.font();
+        font.setBold(true);
+        font.setPixelSize(std::max(6, static_cast<int>(radius * 0.8)));
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(shape.boundingRect(), Qt::AlignCenter, QString(QChar(cell)));
+    }
+}
+
+void HexBoardWidget::paintAnalysis(QPainter& painter, int idx, const QPolygonF& shape) {
+    if (heatLevel[idx] > 0) {
+        const double share = static_cast<double>(heatLevel[idx]) / kAnalysisLevels;
+        const double win = static_cast<double>(heatTone[idx]) / kAnalysisLevels;
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor::fromHsvF(win / 3.0, 0.85, 0.9, 0.15 + 0.6 * share));
+        painter.drawPolygon(shape);
+    }
+    if (pvStep[idx] > 0) {
+        // Ходы варианта чередуются: нечётные — за firstMover.
+        const char mover = pvStep[idx] % 2 == 1 ? pvFirst : (pvFirst == 'X' ? 'O' : 'X');
+        QFont font = painter.font();
+        font.setBold(true);
+        font.setPixelSize(std::max(6, static_cast<int>(radius * 0.7)));
+        painter.setFont(font);
+        painter.setPen(mover == 'X' ? kXColor : kOColor);
+        painter.drawText(shape.boundingRect(), Qt::AlignCenter, QString::number(pvStep[idx]));
+    }
+}
+
+void HexBoardWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    layoutBoard();
+}
+
+void HexBoardWidget::mouseMoveEvent(QMouseEvent* event) {
+    setHovered(cellAt(eventPoint(event)));
+}
+
+void HexBoardWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return;
+    const int idx = cellAt(eventPoint(event));
+    if (idx >= 0) emit cellClicked(idx / boardSize, idx % boardSize);
+}
+
+void HexBoardWidget::leaveEvent(QEvent* event) {
+    QWidget::leaveEvent(event);
+    setHovered(-1);
+}
@@ -0,0 +1,75 @@
+#ifndef HEXBOARDWIDGET_H
+#define HEXBOARDWIDGET_H
+
+#include <QPolygonF>
+#include <QRegion>
+#include <QWidget>
+#include <cstdint>
+#include <vector>
+
+// Доска из шестиугольников, нарисованных QPainter: ряд r сдвинут вправо на
+// полклетки относительно ряда r-1, как в hex_pygame.py. Смена клетки
+// помечает её грязной и перерисовывает только её шестиугольник, поэтому
+// ход стоит одинаково на любой доске. Клик находит клетку по координатам:
+// ближайший центр, затем проверка попадания внутрь шестиугольника.
+class HexBoardWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HexBoardWidget(QWidget* parent = nullptr);
+
+    // Новая пустая доска.
+    void setBoardSize(int size);
+    // cell — 'X', 'O' или '.'.
+    void setCell(int row, int col, char cell);
+    // Анализ движка поверх пустых клеток: яркость — доля посещений хода от
+    // самого посещаемого, цвет — доля побед (красный — проигрыш, зелёный —
+    // выигрыш), числа — главный вариант, первый ход за firstMover.
+    void setAnalysis(const std::vector<float>& visitShare, const std::vector<float>& winRate,
+                     const std::vector<int>& pv, char firstMover);
+    void clearAnalysis();
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+signals:
+    void cellClicked(int row, int col);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void leaveEvent(QEvent* event) override;
+
+private:
+    QPointF cellCenter(int idx) const;
+    QPolygonF hexagon(QPointF center, double extent) const;
+    int cellAt(QPointF point) const;   // -1 — мимо клеток
+    void markDirty(int idx);
+    void setHovered(int idx);
+    void layoutBoard();
+    void paintBoard(QPainter& painter);
+    void paintCell(QPainter& painter, int idx);
+    void paintAnalysis(QPainter& painter, int idx, const QPolygonF& shape);
+
+    int boardSize = 0;
+    std::vector<char> cells;
+    std::vector<int> dirty;            // клетки, ждущие перерисовки
+    std::vector<bool> isDirty;
+    QRegion dirtyRegion;
+    int hovered = -1;
+
+    // Анализ хранится с шагом 1/kAnalysisLevels: клетка перерисовывается,
+    // только когда меняется её вид.
+    std::vector<uint8_t> heatLevel;    // пусто — анализа нет
+    std::vector<uint8_t> heatTone;
+    std::vector<uint8_t> pvStep;       // номер хода в варианте с 1, 0 — вне его
+    char pvFirst = 'X';
+
+    double radius = 0.0;               // от центра до вершины шестиугольника
+    QPointF origin;                    // центр клетки (0, 0)
+};
+
+#endif // HEXBOARDWIDGET_H
@@ -0,0 +1,58 @@
+#ifndef HEXCORE_ANALYSIS_H
+#define HEXCORE_ANALYSIS_H
+
+#include "bitboard.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Тройной буфер: один писатель и один читатель обмениваются снимками без
+// блокировок и никогда не ждут друг друга. Писатель заполняет свой буфер
+// и публикует его обменом с промежуточным; читатель забирает
+// промежуточный, только если там свежий снимок. Непрочитанный снимок
+// заменяется следующим.
+template <typename T>
+class TripleBuffer {
+public:
+    T& writeBuffer() { return buffers[back]; }
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // true — пришёл новый снимок, он в readBuffer().
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& readBuffer() const { return buffers[front]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 3;
+    static constexpr uint8_t kFresh = 4;
+
+    T buffers[3] = {};
+    std::atomic<uint8_t> middle{1};
+    uint8_t back = 0;                // только у писателя
+    uint8_t front = 2;               // только у читателя
+};
+
+// Что видит поиск: ходы корня по клеткам и главный вариант.
+struct AnalysisSnapshot {
+    static constexpr int kMaxPv = 12;
+
+    int size = 0;
+    char toMove = 'X';
+    uint64_t hash = 0;               // позиция корня, чтобы не показать чужой анализ
+    long playouts = 0;               // в этом поиске
+    double playoutsPerSecond = 0.0;
+    uint32_t rootVisits = 0;
+    uint32_t visits[kMaxCells];      // посещения хода в клетку
+    float winRate[kMaxCells];        // доля побед toMove через ход
+    int pvLength = 0;
+    int16_t pv[kMaxPv];              // клетки, первый ход за toMove
+};
+
+using AnalysisBuffer = TripleBuffer<AnalysisSnapshot>;
+
+#endif // HEXCORE_ANALYSIS_H
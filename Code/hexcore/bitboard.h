@@ -0,0 +1,110 @@
+#ifndef HEXCORE_BITBOARD_H
+#define HEXCORE_BITBOARD_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Максимальный размер доски задаётся при сборке: все битборды имеют
+// фиксированную длину, поэтому позиция копируется без выделения памяти.
+#ifndef HEXCORE_MAX_BOARD_SIZE
+#define HEXCORE_MAX_BOARD_SIZE 26
+#endif
+
+constexpr int kMaxBoardSize = HEXCORE_MAX_BOARD_SIZE;
+constexpr int kMaxCells = kMaxBoardSize * kMaxBoardSize;
+
+inline int popCount64(uint64_t x) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(x));
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+inline int lowestBit64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Плоский набор бит на Cells клеток; клетка (r, c) доски N×N имеет индекс r * N + c.
+template <int Cells>
+struct BasicBitboard {
+    static constexpr int kWords = (Cells + 63) / 64;
+
+    uint64_t words[kWords] = {};
+
+    bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+    void set(int i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(int i) { words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    void clear() { for (auto& w : words) w = 0; }
+
+    int count() const {
+        int n = 0;
+        for (uint64_t w : words) n += popCount64(w);
+        return n;
+    }
+
+    bool any() const {
+        uint64_t acc = 0;
+        for (uint64_t w : words) acc |= w;
+        return acc != 0;
+    }
+
+    // Вызывает f(index) для каждого установленного бита по возрастанию.
+    template <class F>
+    void forEach(F&& f) const {
+        for (int k = 0; k < kWords; ++k) {
+            uint64_t w = words[k];
+            while (w) {
+                f(k * 64 + lowestBit64(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    BasicBitboard& operator|=(const BasicBitboard& o) { for (int k = 0; k < kWords; ++k) words[k] |= o.words[k]; return *this; }
+    BasicBitboard& operator&=(const BasicBitboard& o) { for (int k = 0; k < kWords; ++k) words[k] &= o.words[k]; return *this; }
+    BasicBitboard& operator^=(const BasicBitboard& o) { for (int k = 0; k < kWords; ++k) words[k] ^= o.words[k]; return *this; }
+
+    bool intersects(const BasicBitboard& o) const {
+        uint64_t acc = 0;
+        for (int k = 0; k < kWords; ++k) acc |= words[k] & o.words[k];
+        return acc != 0;
+    }
+
+    bool isSubsetOf(const BasicBitboard& o) const {
+        uint64_t acc = 0;
+        for (int k = 0; k < kWords; ++k) acc |= words[k] & ~o.words[k];
+        return acc == 0;
+    }
+
+    // this & ~o
+    BasicBitboard andNot(const BasicBitboard& o) const {
+        BasicBitboard r;
+        for (int k = 0; k < kWords; ++k) r.words[k] = words[k] & ~o.words[k];
+        return r;
+    }
+
+    friend BasicBitboard operator|(BasicBitboard a, const BasicBitboard& b) { return a |= b; }
+    friend BasicBitboard operator&(BasicBitboard a, const BasicBitboard& b) { return a &= b; }
+    friend BasicBitboard operator^(BasicBitboard a, const BasicBitboard& b) { return a ^= b; }
+
+    friend bool operator==(const BasicBitboard& a, const BasicBitboard& b) {
+        uint64_t diff = 0;
+        for (int k = 0; k < kWords; ++k) diff |= a.words[k] ^ b.words[k];
+        return diff == 0;
+    }
+    friend bool operator!=(const BasicBitboard& a, const BasicBitboard& b) { return !(a == b); }
+};
+
+using Bitboard = BasicBitboard<kMaxCells>;
+
+#endif // HEXCORE_BITBOARD_H
@@ -0,0 +1,52 @@
+#include "engine.h"
+
+#include "heuristicai.h"
+#include "mctsai.h"
+#include "smarterai.h"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+RandomEngine::RandomEngine(uint64_t seed) : state(seed) {
+    if (state == 0) {
+        std::random_device rd;
+        state = (uint64_t(rd()) << 32) ^ rd();
+    }
+}
+
+Move RandomEngine::think(const Position& position, const SearchLimits&) {
+    const int N = position.getSize();
+    int empties[kMaxCells];
+    int count = 0;
+    position.emptyCells().forEach([&](int idx) { empties[count++] = idx; });
+    if (count == 0) return Move();
+    // xorshift64*: достаточно для выбора клетки.
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    const int idx = empties[(state * 0x2545F4914F6CDD1Dull >> 32) % count];
+    return {idx / N, idx % N};
+}
+
+std::unique_ptr<Engine> makeEngine(const std::string& spec, uint64_t seed) {
+    size_t pos = spec.find(':');
+    const std::string name = spec.substr(0, pos);
+    std::vector<int> args;
+    while (pos != std::string::npos) {
+        size_t next = spec.find(':', pos + 1);
+        args.push_back(std::atoi(spec.substr(pos + 1, next - pos - 1).c_str()));
+        pos = next;
+    }
+    auto arg = [&args](size_t i, int fallback) { return i < args.size() ? args[i] : fallback; };
+
+    if (name == "random") return std::make_unique<RandomEngine>(seed);
+    if (name == "heuristic") return std::make_unique<HeuristicAI>();
+    if (name == "smarter") return std::make_unique<SmarterAI>('X', arg(0, 4), arg(1, 0));
+    if (name == "mcts") {
+        MctsLimits limits;
+        limits.timeMs = arg(0, 200);
+        return std::make_unique<MctsAI>('X', limits);
+    }
+    return nullptr;
+}
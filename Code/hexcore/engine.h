@@ -0,0 +1,71 @@
+#ifndef HEXCORE_ENGINE_H
+#define HEXCORE_ENGINE_H
+
+#include "hexgame.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct Move {
+    int row = -1;
+    int col = -1;
+    bool swap = false;           // обмен по правилу обмена вместо камня
+
+    bool isValid() const { return swap || (row >= 0 && col >= 0); }
+    static Move swapMove() {
+        Move move;
+        move.swap = true;
+        return move;
+    }
+};
+
+// Позиция — копируемая HexGame без ссылок на окно или живую доску.
+using Position = HexGame;
+
+// Нули означают настройки, заданные движку при создании.
+struct SearchLimits {
+    int timeMs = 0;                           // предел на ход
+    int remainingMs = 0;                      // остаток часов на партию (timemanager.h)
+    int depth = 0;                            // альфа-бета
+    long playouts = 0;                        // MCTS
+    int threads = 0;                          // MCTS, пакетная оценка HeuristicAI
+    const std::atomic<bool>* stop = nullptr;  // прерывание извне
+};
+
+// X ходит первым, дальше ходы чередуются; обмен считается ходом O.
+inline char sideToMove(const Position& position) {
+    return (position.moveCount() + (position.isSwapped() ? 1 : 0)) % 2 == 0 ? 'X' : 'O';
+}
+
+// Ход движка за сторону, которая ходит; false, если ход невозможен.
+inline bool applyMove(Position& position, const Move& move) {
+    if (move.swap) return position.swapSides();
+    return position.makeMove(move.row, move.col, sideToMove(position));
+}
+
+// Общий вход для всех ИИ: ход за сторону, которая ходит в position.
+// Движок ищет на своей копии, поэтому несколько движков могут работать
+// параллельно над одной позицией.
+class Engine {
+public:
+    virtual ~Engine() = default;
+    virtual Move think(const Position& position, const SearchLimits& limits) = 0;
+};
+
+// Случайный ход: нижняя планка для матчей.
+class RandomEngine : public Engine {
+public:
+    explicit RandomEngine(uint64_t seed = 0);
+    Move think(const Position& position, const SearchLimits& limits) override;
+
+private:
+    uint64_t state;
+};
+
+// Движок по описанию "random", "heuristic", "smarter[:глубина[:мс]]" или
+// "mcts[:мс]"; nullptr для неизвестного имени. seed задаёт случайный движок.
+std::unique_ptr<Engine> makeEngine(const std::string& spec, uint64_t seed = 0);
+
+#endif // HEXCORE_ENGINE_H
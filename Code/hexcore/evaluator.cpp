@@ -0,0 +1,285 @@
+#include "evaluator.h"
+
+#include <algorithm>
+
+namespace {
+
+HexEdge targetOf(HexEdge source) {
+    switch (source) {
+    case kEdgeLeft: return kEdgeRight;
+    case kEdgeRight: return kEdgeLeft;
+    case kEdgeTop: return kEdgeBottom;
+    default: return kEdgeTop;
+    }
+}
+
+} // namespace
+
+DistanceField::DistanceField(char player, HexEdge source)
+    : player(player), source(source) {
+    changes.reserve(4 * kMaxCells);
+    changeMarks.reserve(kMaxCells);
+    std::fill(mark, mark + kMaxCells, 0u);
+}
+
+void DistanceField::setCell(int cell, int d, int from) {
+    if (logging) changes.push_back({static_cast<int16_t>(cell), dist[cell], parent[cell]});
+    dist[cell] = static_cast<int16_t>(d);
+    parent[cell] = static_cast<int16_t>(from);
+}
+
+void DistanceField::compute(const HexGame& game) {
+    const BoardGeometry& geo = game.geometry();
+    std::fill(dist, dist + geo.cells, kUnreachable);
+    std::fill(parent, parent + geo.cells, int16_t(-1));
+    changes.clear();
+    changeMarks.clear();
+    logging = false;
+
+    queue.clear();
+    geo.edge[source].forEach([&](int idx) {
+        int cost = cellCost(game, idx);
+        if (cost < 0) return;
+        dist[idx] = static_cast<int16_t>(cost);
+        if (cost == 0) queue.pushFront(idx);
+        else queue.pushBack(idx);
+    });
+    propagate(game);
+}
+
+void DistanceField::propagate(const HexGame& game) {
+    const BoardGeometry& geo = game.geometry();
+    // Клетка может попасть в очередь несколько раз, если её расстояние
+    // улучшилось; повторная обработка лишь ничего не меняет.
+    while (!queue.empty()) {
+        int v = queue.popFront();
+        int d = dist[v];
+        for (int nb : geo.neighbors[v]) {
+            if (nb < 0) continue;
+            int cost = cellCost(game, nb);
+            if (cost < 0 || dist[nb] <= d + cost) continue;
+            setCell(nb, d + cost, v);
+            if (cost == 0) queue.pushFront(nb);
+            else queue.pushBack(nb);
+        }
+    }
+}
+
+void DistanceField::placeStone(const HexGame& game, int cell) {
+    changeMarks.push_back(static_cast<int>(changes.size()));
+    logging = true;
+    queue.clear();
+    if (dist[cell] == kUnreachable) {
+        // Клетка была недостижима: свой камень её не откроет, а чужой
+        // ничего не отрежет.
+        if (cellCost(game, cell) < 0) setCell(cell, kUnreachable, -1);
+        logging = false;
+        return;
+    }
+
+    if (cellCost(game, cell) == 0) {
+        // Свой камень: клетка подешевела на 1, расстояния только уменьшаются.
+        setCell(cell, dist[cell] - 1, parent[cell]);
+        queue.pushFront(cell);
+        propagate(game);
+        logging = false;
+        return;
+    }
+
+    // Чужой камень: увеличиться могут только расстояния клеток, чей
+    // кратчайший путь шёл через cell, то есть её поддерево родителей.
+    const BoardGeometry& geo = game.geometry();
+    if (++markGeneration == 0) {
+        std::fill(mark, mark + kMaxCells, 0u);
+        markGeneration = 1;
+    }
+    int16_t stack[kMaxCells];
+    int16_t affected[kMaxCells];
+    int top = 0;
+    int count = 0;
+    stack[top++] = static_cast<int16_t>(cell);
+    mark[cell] = markGeneration;
+    while (top > 0) {
+        int u = stack[--top];
+        affected[count++] = static_cast<int16_t>(u);
+        for (int nb : geo.neighbors[u]) {
+            if (nb >= 0 && mark[nb] != markGeneration && parent[nb] == u) {
+                mark[nb] = markGeneration;
+                stack[top++] = static_cast<int16_t>(nb);
+            }
+        }
+    }
+    for (int i = 0; i < count; ++i) setCell(affected[i], kUnreachable, -1);
+
+    // Каждая затронутая клетка получает лучшее значение от соседей вне
+    // поддерева, после чего волна расходится по поддереву.
+    for (int i = 1; i < count; ++i) {
+        int w = affected[i];
+        int cost = cellCost(game, w);
+        int best = geo.edge[source].test(w) ? cost : kUnreachable;
+        int from = -1;
+        for (int nb : geo.neighbors[w]) {
+            if (nb < 0 || mark[nb] == markGeneration || dist[nb] == kUnreachable) continue;
+            if (dist[nb] + cost < best) {
+                best = dist[nb] + cost;
+                from = nb;
+            }
+        }
+        if (best < kUnreachable) {
+            setCell(w, best, from);
+            queue.pushBack(w);
+        }
+    }
+    propagate(game);
+    logging = false;
+}
+
+void DistanceField::undo() {
+    if (changeMarks.empty()) return;
+    const int start = changeMarks.back();
+    changeMarks.pop_back();
+    for (int i = static_cast<int>(changes.size()) - 1; i >= start; --i) {
+        dist[changes[i].cell] = changes[i].dist;
+        parent[changes[i].cell] = changes[i].parent;
+    }
+    changes.resize(start);
+}
+
+int DistanceField::pathTo(const HexGame& game, HexEdge target, CellPath* path) const {
+    int best = -1;
+    game.geometry().edge[target].forEach([&](int idx) {
+        if (dist[idx] < kUnreachable && (best < 0 || dist[idx] < dist[best])) best = idx;
+    });
+    if (best < 0) return kNoPath;
+    if (path) {
+        const int N = game.getSize();
+        path->clear();
+        for (int cur = best; cur != -1; cur = parent[cur]) {
+            if (game.isCellEmpty(cur / N, cur % N)) path->push_back({cur / N, cur % N});
+        }
+        std::reverse(path->begin(), path->end());
+    }
+    return dist[best];
+}
+
+HexEvaluator::HexEvaluator()
+    : fields{DistanceField('X', kEdgeLeft), DistanceField('O', kEdgeTop)} {
+}
+
+void HexEvaluator::reset(const HexGame& game) {
+    fields[0].compute(game);
+    fields[1].compute(game);
+}
+
+void HexEvaluator::play(const HexGame& game) {
+    const int cell = game.lastMove();
+    fields[0].placeStone(game, cell);
+    fields[1].placeStone(game, cell);
+}
+
+void HexEvaluator::undo() {
+    fields[0].undo();
+    fields[1].undo();
+}
+
+int HexEvaluator::shortestPath(const HexGame& game, char player, CellPath* path) const {
+    const int color = colorIndex(player);
+    return fields[color].pathTo(game, color == 0 ? kEdgeRight : kEdgeBottom, path);
+}
+
+void HexEvaluator::twoDistanceFrom(const HexGame& game, char player, HexEdge source, int16_t* td) {
+    const BoardGeometry& geo = game.geometry();
+    const Bitboard& own = game.stonesOf(player);
+    const Bitboard& enemy = game.stonesOf(opponentOf(player));
+    constexpr int16_t kEdgeContact = -2;
+
+    std::fill(td, td + geo.cells, DistanceField::kUnreachable);
+    std::fill(contacts, contacts + geo.cells, uint8_t(0));
+    std::fill(firstContact, firstContact + geo.cells, int16_t(-1));
+
+    // Пустая клетка получает значение второго по близости соседа плюс 1:
+    // соперник может закрыть лучший подход, но не оба сразу. Своя группа —
+    // один сосед, сторона доски — сразу два.
+    queue.clear();
+    geo.edge[source].forEach([&](int idx) {
+        if (enemy.test(idx)) return;
+        if (own.test(idx)) {
+            td[idx] = 0;
+            queue.pushFront(idx);
+        } else {
+            td[idx] = 1;
+            contacts[idx] = 2;
+            firstContact[idx] = kEdgeContact;
+            queue.pushBack(idx);
+        }
+    });
+
+    uint8_t done[kMaxCells] = {};
+    while (!queue.empty()) {
+        int v = queue.popFront();
+        if (done[v]) continue;
+        done[v] = 1;
+        const int16_t contact = own.test(v) ? groupOf[v] : static_cast<int16_t>(v);
+        for (int nb : geo.neighbors[v]) {
+            if (nb < 0 || done[nb] || enemy.test(nb)) continue;
+            if (own.test(nb)) {
+                if (td[nb] > td[v]) {
+                    td[nb] = td[v];
+                    queue.pushFront(nb);
+                }
+                continue;
+            }
+            if (contacts[nb] >= 2 || firstContact[nb] == contact) continue;
+            if (++contacts[nb] == 1) {
+                firstContact[nb] = contact;
+            } else {
+                td[nb] = static_cast<int16_t>(td[v] + 1);
+                queue.pushBack(nb);
+            }
+        }
+    }
+}
+
+int HexEvaluator::twoDistance(const HexGame& game, char player, int* mobility) {
+    const BoardGeometry& geo = game.geometry();
+    const Bitboard& own = game.stonesOf(player);
+
+    // Группы своих камней: представитель — первая клетка обхода.
+    std::fill(groupOf, groupOf + geo.cells, int16_t(-1));
+    int16_t stack[kMaxCells];
+    own.forEach([&](int idx) {
+        if (groupOf[idx] >= 0) return;
+        int top = 0;
+        stack[top++] = static_cast<int16_t>(idx);
+        groupOf[idx] = static_cast<int16_t>(idx);
+        while (top > 0) {
+            int v = stack[--top];
+            for (int nb : geo.neighbors[v]) {
+                if (nb >= 0 && own.test(nb) && groupOf[nb] < 0) {
+                    groupOf[nb] = static_cast<int16_t>(idx);
+                    stack[top++] = static_cast<int16_t>(nb);
+                }
+            }
+        }
+    });
+
+    const HexEdge source = player == 'X' ? kEdgeLeft : kEdgeTop;
+    twoDistanceFrom(game, player, source, twoDist[0]);
+    twoDistanceFrom(game, player, targetOf(source), twoDist[1]);
+
+    int potential = kNoPath;
+    int count = 0;
+    game.emptyCells().forEach([&](int idx) {
+        if (twoDist[0][idx] >= DistanceField::kUnreachable || twoDist[1][idx] >= DistanceField::kUnreachable)
+            return;
+        int sum = twoDist[0][idx] + twoDist[1][idx];
+        if (sum < potential) {
+            potential = sum;
+            count = 1;
+        } else if (sum == potential) {
+            ++count;
+        }
+    });
+    if (mobility) *mobility = count;
+    return potential;
+}
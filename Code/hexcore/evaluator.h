@@ -0,0 +1,115 @@
+#ifndef HEXCORE_EVALUATOR_H
+#define HEXCORE_EVALUATOR_H
+
+#include "hexgame.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using CellPath = std::vector<std::pair<int, int>>;
+
+constexpr int kNoPath = 1'000'000'000;
+
+// Двусторонняя очередь на кольцевом буфере для 0-1 BFS: ход на свой камень
+// бесплатен и идёт в начало, на пустую клетку стоит 1 и идёт в конец.
+class CellDeque {
+public:
+    void clear() { head = tail = 0; }
+    bool empty() const { return head == tail; }
+    void pushFront(int cell) { items[--head & kMask] = static_cast<int16_t>(cell); }
+    void pushBack(int cell) { items[tail++ & kMask] = static_cast<int16_t>(cell); }
+    int popFront() { return items[head++ & kMask]; }
+
+private:
+    static constexpr unsigned kSize = [] {
+        unsigned n = 1;
+        while (n < 8u * kMaxCells) n *= 2;
+        return n;
+    }();
+    static constexpr unsigned kMask = kSize - 1;
+
+    int16_t items[kSize];
+    unsigned head = 0;
+    unsigned tail = 0;
+};
+
+// Расстояния от одной стороны для одного игрока: сколько пустых клеток
+// нужно занять, чтобы дотянуться до клетки. Свои камни стоят 0, чужие
+// непроходимы. После одного хода поле обновляется инкрементально, а
+// изменения пишутся в журнал для отката.
+class DistanceField {
+public:
+    static constexpr int16_t kUnreachable = 0x3FFF;
+
+    DistanceField(char player = 'X', HexEdge source = kEdgeLeft);
+
+    void compute(const HexGame& game);
+    // game уже содержит камень на cell.
+    void placeStone(const HexGame& game, int cell);
+    // Откат последнего placeStone.
+    void undo();
+
+    int distance(int cell) const { return dist[cell]; }
+    // Минимум ходов до стороны target или kNoPath; в path — пустые клетки
+    // кратчайшего пути от источника.
+    int pathTo(const HexGame& game, HexEdge target, CellPath* path = nullptr) const;
+
+private:
+    struct Change {
+        int16_t cell;
+        int16_t dist;
+        int16_t parent;
+    };
+
+    int cellCost(const HexGame& game, int cell) const {
+        if (game.stonesOf(player).test(cell)) return 0;
+        return game.stonesOf(opponentOf(player)).test(cell) ? -1 : 1;
+    }
+    void setCell(int cell, int d, int from);
+    void propagate(const HexGame& game);
+
+    char player;
+    HexEdge source;
+    bool logging = false;
+    int16_t dist[kMaxCells];
+    int16_t parent[kMaxCells];
+    uint32_t mark[kMaxCells];        // метки поколений для обхода поддерева
+    uint32_t markGeneration = 0;
+    CellDeque queue;
+    std::vector<Change> changes;
+    std::vector<int> changeMarks;    // размер журнала перед каждым placeStone
+};
+
+// Оценщик позиции: кратчайшие пути обоих игроков с инкрементальным
+// обновлением и потенциал по двухрасстоянию (two-distance).
+class HexEvaluator {
+public:
+    HexEvaluator();
+
+    void reset(const HexGame& game);
+    // Учитывает последний ход game; откатывается через undo.
+    void play(const HexGame& game);
+    void undo();
+
+    // Минимум ходов до соединения сторон игрока или kNoPath; в path —
+    // пустые клетки кратчайшего пути от первой стороны ко второй.
+    int shortestPath(const HexGame& game, char player, CellPath* path = nullptr) const;
+
+    // Потенциал по двухрасстоянию: минимум по пустым клеткам суммы
+    // двухрасстояний до обеих сторон; в mobility — число клеток с этим
+    // минимумом. Чем меньше потенциал, тем ближе игрок к соединению.
+    int twoDistance(const HexGame& game, char player, int* mobility = nullptr);
+
+private:
+    void twoDistanceFrom(const HexGame& game, char player, HexEdge source, int16_t* td);
+
+    DistanceField fields[2];         // X от левой стороны, O от верхней
+    int16_t twoDist[2][kMaxCells];
+    int16_t groupOf[kMaxCells];
+    uint8_t contacts[kMaxCells];
+    int16_t firstContact[kMaxCells];
+    CellDeque queue;
+};
+
+#endif // HEXCORE_EVALUATOR_H
@@ -0,0 +1,48 @@
+#include "gamehistory.h"
+
+GameHistory::GameHistory(const HexGame& start)
+    : current(start) {
+    reset(start);
+}
+
+void GameHistory::reset(const HexGame& start) {
+    current = start;
+    auto root = std::make_shared<HistoryNode>();
+    root->snapshot = std::make_shared<const HexGame>(start);
+    root->hash = start.hash();
+    line.assign(1, std::move(root));
+    cursor = 0;
+}
+
+bool GameHistory::play(const Move& move) {
+    if (canRedo()) {
+        const Move& next = line[cursor + 1]->move;
+        if (next.swap == move.swap && (move.swap || (next.row == move.row && next.col == move.col))) return redo();
+    }
+    if (!applyMove(current, move)) return false;
+    auto node = std::make_shared<HistoryNode>();
+    node->parent = line[cursor];
+    node->move = move;
+    node->ply = cursor + 1;
+    node->hash = current.hash();
+    if (node->ply % kSnapshotInterval == 0) node->snapshot = std::make_shared<const HexGame>(current);
+    line.resize(cursor + 1);
+    line.push_back(std::move(node));
+    ++cursor;
+    return true;
+}
+
+bool GameHistory::jumpTo(int at) {
+    if (at < 0 || at > length()) return false;
+    if (at == cursor) return true;
+    // Ближайшая копия не позже цели, дальше — ходы линии.
+    int base = at - at % kSnapshotInterval;
+    HexGame position = *line[base]->snapshot;
+    while (base < at) {
+        if (!applyMove(position, line[++base]->move)) return false;
+    }
+    if (position.hash() != line[at]->hash) return false;
+    current = position;
+    cursor = at;
+    return true;
+}
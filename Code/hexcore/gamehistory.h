@@ -0,0 +1,54 @@
+#ifndef HEXCORE_GAMEHISTORY_H
+#define HEXCORE_GAMEHISTORY_H
+
+#include "engine.h"
+#include "hexgame.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Узел истории: ход и позиция после него. Узлы неизменяемы и ссылаются на
+// родителя, поэтому ветвь, начатая после отмены, делит с прежней общее
+// начало. Каждый GameHistory::kSnapshotInterval-й узел хранит копию
+// позиции, общую для всех ветвей через него.
+struct HistoryNode {
+    std::shared_ptr<const HistoryNode> parent;
+    std::shared_ptr<const HexGame> snapshot;
+    Move move;              // ход, ведущий в узел; у начальной позиции невалиден
+    int ply = 0;
+    uint64_t hash = 0;      // хэш позиции после хода, для сверки
+};
+
+// Ходы партии с отменой, возвратом и переходом к любому ходу. Позиция
+// восстанавливается от ближайшей копии не больше чем за
+// kSnapshotInterval - 1 ходов, как бы далеко ни был переход.
+class GameHistory {
+public:
+    static constexpr int kSnapshotInterval = 16;
+
+    explicit GameHistory(const HexGame& start);
+    void reset(const HexGame& start);
+
+    const HexGame& position() const { return current; }
+    int ply() const { return cursor; }
+    // Ходов в линии, включая отменённые, которые можно вернуть.
+    int length() const { return static_cast<int>(line.size()) - 1; }
+    const HistoryNode& node(int at) const { return *line[at]; }
+    bool canUndo() const { return cursor > 0; }
+    bool canRedo() const { return cursor < length(); }
+
+    // Ход в текущей позиции. Отменённые ходы сохраняются, только если он
+    // совпадает со следующим из них; иначе линия продолжается новой ветвью.
+    bool play(const Move& move);
+    bool undo() { return jumpTo(cursor - 1); }
+    bool redo() { return jumpTo(cursor + 1); }
+    bool jumpTo(int at);
+
+private:
+    std::vector<std::shared_ptr<const HistoryNode>> line;   // line[k] — после k ходов
+    int cursor = 0;
+    HexGame current;
+};
+
+#endif // HEXCORE_GAMEHISTORY_H
@@ -0,0 +1,223 @@
+#include "gamerecord.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+constexpr char kGameFileMagic[8] = {'H', 'E', 'X', 'G', 'A', 'M', 'E', '1'};
+constexpr uint8_t kFlagSwapRule = 1;
+constexpr uint8_t kWinnerShift = 1;   // два бита: 0 — нет, 1 — X, 2 — O
+constexpr size_t kRecordHeader = 4;
+
+// Байт на ход, пока номер клетки и отметка обмена помещаются в байт.
+int moveBytes(int size) {
+    return size * size < 255 ? 1 : 2;
+}
+
+int swapCode(int size) {
+    return moveBytes(size) == 1 ? 0xFF : 0xFFFF;
+}
+
+} // namespace
+
+GameRecord GameRecord::fromGame(const HexGame& game) {
+    GameRecord record;
+    const int N = game.getSize();
+    record.size = N;
+    record.swapRule = game.hasSwapRule();
+    record.moves.reserve(game.moveCount() + 1);
+    for (int k = 0; k < game.moveCount(); ++k) {
+        int cell = game.moveAt(k);
+        if (k == 0 && game.isSwapped()) cell = (cell % N) * N + cell / N;
+        record.moves.push_back({cell / N, cell % N});
+        if (k == 0 && game.isSwapped()) record.moves.push_back(Move::swapMove());
+    }
+    if (game.checkWin('X')) record.winner = 'X';
+    else if (game.checkWin('O')) record.winner = 'O';
+    return record;
+}
+
+bool GameRecord::replay(HexGame& game, size_t plies) const {
+    if (size < 1 || size > kMaxBoardSize) return false;
+    game = HexGame(size, swapRule);
+    const size_t count = std::min(plies, moves.size());
+    for (size_t k = 0; k < count; ++k) {
+        if (!applyMove(game, moves[k])) return false;
+    }
+    return true;
+}
+
+std::string cellName(int row, int col) {
+    return std::string(1, static_cast<char>('a' + col)) + std::to_string(row + 1);
+}
+
+bool parseCell(const std::string& text, int size, int& row, int& col) {
+    if (text.size() < 2 || !std::islower(static_cast<unsigned char>(text[0]))) return false;
+    int number = 0;
+    for (size_t i = 1; i < text.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i])) || number > kMaxBoardSize) return false;
+        number = number * 10 + (text[i] - '0');
+    }
+    row = number - 1;
+    col = text[0] - 'a';
+    return row >= 0 && row < size && col < size;
+}
+
+std::string formatRecord(const GameRecord& record) {
+    std::string text = std::to_string(record.size);
+    if (record.swapRule) text += " swap";
+    text += ':';
+    for (const Move& move : record.moves) {
+        text += ' ';
+        text += move.swap ? std::string("swap") : cellName(move.row, move.col);
+    }
+    if (record.winner) {
+        text += ' ';
+        text += record.winner;
+    }
+    return text;
+}
+
+bool parseRecord(const std::string& line, GameRecord& record) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) return false;
+    std::istringstream header(line.substr(0, colon));
+    std::string token;
+    if (!(header >> record.size) || record.size < 1 || record.size > kMaxBoardSize) return false;
+    record.swapRule = false;
+    while (header >> token) {
+        if (token != "swap") return false;
+        record.swapRule = true;
+    }
+
+    record.winner = 0;
+    record.moves.clear();
+    std::istringstream body(line.substr(colon + 1));
+    while (body >> token) {
+        if (record.winner) return false;   // после победителя ходов нет
+        if (token == "X" || token == "O") {
+            record.winner = token[0];
+        } else if (token == "swap" || token == "swap-pieces") {
+            record.moves.push_back(Move::swapMove());
+        } else {
+            Move move;
+            if (!parseCell(token, record.size, move.row, move.col)) return false;
+            record.moves.push_back(move);
+        }
+    }
+    return true;
+}
+
+bool appendTextRecord(const std::string& path, const GameRecord& record) {
+    std::ofstream out(path, std::ios::app);
+    out << formatRecord(record) << '\n';
+    return static_cast<bool>(out);
+}
+
+bool GameWriter::open(const std::string& path, bool append) {
+    close();
+    // Дописывать можно только в файл партий; пустой или новый получает заголовок.
+    bool needHeader = true;
+    if (append) {
+        std::ifstream probe(path, std::ios::binary);
+        char magic[sizeof(kGameFileMagic)];
+        if (probe.read(magic, sizeof(magic))) {
+            if (std::memcmp(magic, kGameFileMagic, sizeof(magic)) != 0) return false;
+            needHeader = false;
+        } else if (probe.gcount() > 0) {
+            return false;
+        }
+    }
+    out.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (needHeader) out.write(kGameFileMagic, sizeof(kGameFileMagic));
+    return static_cast<bool>(out);
+}
+
+bool GameWriter::write(const GameRecord& record) {
+    if (!out || record.size < 1 || record.size > kMaxBoardSize || record.moves.size() > 0xFFFF) return false;
+    const int width = moveBytes(record.size);
+    uint8_t flags = record.swapRule ? kFlagSwapRule : 0;
+    if (record.winner == 'X') flags |= 1 << kWinnerShift;
+    else if (record.winner == 'O') flags |= 2 << kWinnerShift;
+    const size_t count = record.moves.size();
+
+    buffer.resize(kRecordHeader + count * width);
+    buffer[0] = static_cast<uint8_t>(record.size);
+    buffer[1] = flags;
+    buffer[2] = static_cast<uint8_t>(count & 0xFF);
+    buffer[3] = static_cast<uint8_t>(count >> 8);
+    uint8_t* p = buffer.data() + kRecordHeader;
+    for (const Move& move : record.moves) {
+        const int code = move.swap ? swapCode(record.size) : move.row * record.size + move.col;
+        *p++ = static_cast<uint8_t>(code & 0xFF);
+        if (width == 2) *p++ = static_cast<uint8_t>(code >> 8);
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+void GameWriter::close() {
+    if (out.is_open()) out.close();
+    out.clear();
+}
+
+bool GameReader::open(const std::string& path) {
+    close();
+    in.open(path, std::ios::binary);
+    char magic[sizeof(kGameFileMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kGameFileMagic, sizeof(magic)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool GameReader::next(GameRecord& record) {
+    if (!in.is_open() || corrupt) return false;
+    uint8_t header[kRecordHeader];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (in.gcount() == 0) return false;   // конец файла ровно на границе записи
+    const int size = header[0];
+    const size_t moveCount = header[2] | static_cast<size_t>(header[3]) << 8;
+    const int winner = (header[1] >> kWinnerShift) & 3;
+    if (in.gcount() != sizeof(header) || size < 1 || size > kMaxBoardSize || winner == 3) {
+        corrupt = true;
+        return false;
+    }
+    const int width = moveBytes(size);
+    buffer.resize(moveCount * width);
+    if (!in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+        corrupt = true;
+        return false;
+    }
+
+    record.size = size;
+    record.swapRule = (header[1] & kFlagSwapRule) != 0;
+    record.winner = winner == 1 ? 'X' : winner == 2 ? 'O' : 0;
+    record.moves.resize(moveCount);
+    const uint8_t* p = buffer.data();
+    for (size_t k = 0; k < moveCount; ++k) {
+        int code = *p++;
+        if (width == 2) code |= *p++ << 8;
+        if (code == swapCode(size)) {
+            record.moves[k] = Move::swapMove();
+        } else if (code < size * size) {
+            record.moves[k] = {code / size, code % size};
+        } else {
+            corrupt = true;
+            return false;
+        }
+    }
+    ++count;
+    return true;
+}
+
+void GameReader::close() {
+    if (in.is_open()) in.close();
+    in.clear();
+    count = 0;
+    corrupt = false;
+}
@@ -0,0 +1,78 @@
+#ifndef HEXCORE_GAMERECORD_H
+#define HEXCORE_GAMERECORD_H
+
+#include "engine.h"
+#include "hexgame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Запись партии: доска, правило обмена, ходы по порядку (обмен —
+// Move::swapMove()) и победитель.
+struct GameRecord {
+    int size = 0;
+    bool swapRule = false;
+    char winner = 0;              // 'X', 'O' или 0 — партия не доиграна
+    std::vector<Move> moves;
+
+    // Партия, сыгранная на game. После обмена первый ход восстанавливается
+    // из отражённого камня O.
+    static GameRecord fromGame(const HexGame& game);
+
+    // Позиция после первых plies ходов; false, если размер недопустим или
+    // ход записи невозможен.
+    bool replay(HexGame& game, size_t plies = SIZE_MAX) const;
+};
+
+// Текстовая запись в принятой для Гекса нотации: столбец — буква, ряд —
+// число с единицы ("a1" — угол у начала сторон обоих игроков), обмен —
+// "swap". Партия — одна строка: размер, пометка правила обмена, двоеточие,
+// ходы и, если партия закончена, победитель:
+//   11 swap: a1 swap f6 e7 O
+std::string cellName(int row, int col);
+bool parseCell(const std::string& text, int size, int& row, int& col);
+std::string formatRecord(const GameRecord& record);
+bool parseRecord(const std::string& line, GameRecord& record);
+// Дописывает партию строкой в текстовый файл.
+bool appendTextRecord(const std::string& path, const GameRecord& record);
+
+// Файл партий: заголовок "HEXGAME1" и записи подряд. Запись —
+// размер, флаги (правило обмена, победитель), число ходов (2 байта) и
+// ходы: по байту на ход, пока клеток меньше 255, иначе по 2 байта;
+// наибольшее значение означает обмен. Числа — little-endian.
+class GameWriter {
+public:
+    // append дописывает в конец существующего файла.
+    bool open(const std::string& path, bool append = false);
+    bool write(const GameRecord& record);
+    void close();
+    bool isOpen() const { return out.is_open(); }
+
+private:
+    std::ofstream out;
+    std::vector<uint8_t> buffer;
+};
+
+// Чтение файла партий по одной: память не зависит от длины файла, а
+// запись, переданная в next, переиспользуется, поэтому миллионы партий
+// читаются без выделений памяти на каждую.
+class GameReader {
+public:
+    bool open(const std::string& path);
+    // false в конце файла или на испорченной записи — их различает failed().
+    bool next(GameRecord& record);
+    void close();
+    bool failed() const { return corrupt; }
+    size_t gamesRead() const { return count; }
+
+private:
+    std::ifstream in;
+    std::vector<uint8_t> buffer;
+    size_t count = 0;
+    bool corrupt = false;
+};
+
+#endif // HEXCORE_GAMERECORD_H
@@ -0,0 +1,549 @@
+#include "heuristicai.h"
+
+#include "inferior.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+using std::vector;
+using std::pair;
+
+static const int kHexDirections[6][2] = {
+    {-1, 0}, {-1, 1}, {0, -1},
+    {0, 1}, {1, -1}, {1, 0}
+};
+
+namespace {
+
+// Для O направление соединения — строки, для X — столбцы. Эвристики
+// записаны в координатах «вдоль» и «поперёк» этого направления, поэтому
+// одинаково работают за оба цвета.
+int alongOf(char player, int r, int c) { return player == 'O' ? r : c; }
+int acrossOf(char player, int r, int c) { return player == 'O' ? c : r; }
+
+pair<int, int> cellAt(char player, int along, int across) {
+    return player == 'O' ? pair<int, int>{along, across} : pair<int, int>{across, along};
+}
+
+HexEdge targetEdge(char player) { return player == 'X' ? kEdgeRight : kEdgeBottom; }
+
+// Поля с буферами на поток: X от левой стороны, O от верхней. Разовые
+// проверки угроз и пакетная оценка не выделяют память.
+DistanceField* threadFields() {
+    thread_local DistanceField fields[2] = {DistanceField('X', kEdgeLeft), DistanceField('O', kEdgeTop)};
+    return fields;
+}
+
+// Меньше стольких ходов на поток пакет не делится: запуск потока дороже.
+constexpr size_t kMinMovesPerThread = 8;
+
+} // namespace
+
+int HeuristicAI::minMovesToWin(const HexGame& game, char player, CellPath* path) {
+    DistanceField& field = threadFields()[colorIndex(player)];
+    field.compute(game);
+    return field.pathTo(game, targetEdge(player), path);
+}
+
+bool HeuristicAI::isOneMoveFromWin(const HexGame& game, char player) {
+    return minMovesToWin(game, player) <= 1;
+}
+
+bool HeuristicAI::isTwoMovesFromWin(const HexGame& game, char player) {
+    return minMovesToWin(game, player) <= 2;
+}
+
+int HeuristicAI::shortestPathToConnect(const HexGame& game, char player, int r, int c) {
+    int size = game.getSize();
+    int along = alongOf(player, r, c);
+    int distToStart = along;
+    int distToEnd = size - 1 - along;
+    const char opponent = opponentOf(player);
+    int opponentNearby = 0;
+    for (int d = 0; d < 6; ++d) {
+        int nr = r + kHexDirections[d][0];
+        int nc = c + kHexDirections[d][1];
+        if (nr >= 0 && nr < size && nc >= 0 && nc < size && game.getCell(nr, nc) == opponent) {
+            opponentNearby++;
+        }
+    }
+    return distToStart + distToEnd + opponentNearby * 2;
+}
+
+int HeuristicAI::evaluateMove(HexGame& game, char player, int r, int c, int opponentLastR, int opponentLastC,
+                              int baseThreatCost,
+                              const CellPath& threatPath,
+                              int baseOwnPathCost,
+                              const CellPath& ownPath) {
+    if (game.checkWin(player)) return 5000000;
+    const MoveContext context{opponentLastR, opponentLastC, baseThreatCost, threatPath, baseOwnPathCost, ownPath};
+    const int newThreat = minMovesToWin(game, opponentOf(player));
+    return scoreMove(game, player, r, c, context, newThreat, minMovesToWin(game, player));
+}
+
+// game уже содержит камень player на (r, c); newThreat и newOwnPathCost —
+// кратчайшие пути соперника и свой после него.
+int HeuristicAI::scoreMove(const HexGame& game, char player, int r, int c, const MoveContext& context,
+                           int newThreat, int newOwnPathCost) {
+    int size = game.getSize();
+    const char opponent = opponentOf(player);
+    const int along = alongOf(player, r, c);
+    const int across = acrossOf(player, r, c);
+    const int lastAlong = alongOf(player, context.opponentLastR, context.opponentLastC);
+    int score = 0;
+    int threatDelta = context.threatCost - newThreat;
+    if (newThreat <= 1) score += 800000;
+    if (threatDelta > 0) score += threatDelta * 400000;
+    for (const auto& cell : context.threatPath) {
+        if (cell.first == r && cell.second == c) {
+            score += 180000;
+            break;
+        }
+    }
+    int ownGain = context.ownPathCost - newOwnPathCost;
+    if (newOwnPathCost <= 1) score += 700000;
+    if (ownGain > 0) score += ownGain * 300000;
+    for (const auto& cell : context.ownPath) {
+        if (cell.first == r && cell.second == c) {
+            score += 250000; // бонус за продвижение по своему кратчайшему пути
+            break;
+        }
+    }
+    // Угроза после нашего хода уже посчитана в newThreat.
+    if (newThreat <= 1) score += 2500000;
+    else if (newThreat <= 2) score += 2000000;
+    int pathScore = shortestPathToConnect(game, player, r, c);
+    score += (size * 3 - pathScore) * 8000;
+    if (along >= size - 2) score += 120000; // агрессивно блокируем дальний край
+    if (lastAlong >= size - 2 && std::abs(along - lastAlong) <= 1) score += 120000;
+    int distToOpponent = std::abs(r - context.opponentLastR) + std::abs(c - context.opponentLastC);
+    if (distToOpponent <= 2) score += (3 - distToOpponent) * 10000;
+    if (across >= size - 3) score += 8000;
+    if (along <= 1 || along >= size - 2) score += 5000;
+    int neighbors = 0;
+    for (int d = 0; d < 6; ++d) {
+        int nr = r + kHexDirections[d][0];
+        int nc = c + kHexDirections[d][1];
+        if (nr >= 0 && nr < size && nc >= 0 && nc < size) {
+            if (game.getCell(nr, nc) == player) neighbors += 2;
+            if (game.getCell(nr, nc) == opponent) neighbors += 1;
+        }
+    }
+    score += neighbors * 1000;
+    int centerDist = std::abs(r - size/2) + std::abs(c - size/2);
+    score += (size - centerDist) * 200;
+    return score;
+}
+
+std::vector<int> HeuristicAI::evaluateMoves(const HexGame& game, char player, const CellPath& moves,
+                                            const MoveContext& context, int threads, const TimeManager* timing) {
+    std::vector<int> scores;
+    evaluateMoves(game, player, moves, context, scores, threads, timing);
+    return scores;
+}
+
+void HeuristicAI::evaluateMoves(const HexGame& game, char player, const CellPath& moves,
+                                const MoveContext& context, std::vector<int>& scores, int threads,
+                                const TimeManager* timing) {
+    scores.assign(moves.size(), -kNoPath);
+    if (moves.empty()) return;
+    // Базовые поля считаются один раз. Помощники получают свои копии до
+    // запуска потоков: вызывающий поток сразу начинает менять свои поля.
+    DistanceField* fields = threadFields();
+    fields[0].compute(game);
+    fields[1].compute(game);
+    const size_t helpers = std::min(static_cast<size_t>(std::max(1, threads)),
+                                    std::max<size_t>(1, moves.size() / kMinMovesPerThread)) - 1;
+    std::vector<DistanceField> copies;
+    copies.reserve(2 * helpers);
+    for (size_t t = 0; t < helpers; ++t) {
+        copies.push_back(fields[0]);
+        copies.push_back(fields[1]);
+    }
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t <= helpers; ++t) {
+        DistanceField* own = &copies[2 * (t - 1)];
+        pool.emplace_back([&, t, own] { evaluateSlice(game, player, moves, context, own, scores.data(), t, helpers + 1, timing); });
+    }
+    evaluateSlice(game, player, moves, context, fields, scores.data(), 0, helpers + 1, timing);
+    for (auto& th : pool) th.join();
+}
+
+// Ходы first, first + step, ...; fields — базовые поля обоих игроков,
+// принадлежащие только этому вызову: они меняются и откатываются.
+void HeuristicAI::evaluateSlice(const HexGame& base, char player, const CellPath& moves, const MoveContext& context,
+                                DistanceField* fields, int* scores, size_t first, size_t step,
+                                const TimeManager* timing) {
+    HexGame game = base;
+    const int N = game.getSize();
+    DistanceField& own = fields[colorIndex(player)];
+    DistanceField& threat = fields[1 - colorIndex(player)];
+    const HexEdge ownTarget = targetEdge(player);
+    const HexEdge threatTarget = targetEdge(opponentOf(player));
+    for (size_t i = first; i < moves.size(); i += step) {
+        if (timing && timing->hardExpired()) break;
+        const int r = moves[i].first;
+        const int c = moves[i].second;
+        if (!game.makeMove(r, c, player)) continue;
+        if (game.checkWin(player)) {
+            scores[i] = 5000000;
+        } else {
+            own.placeStone(game, r * N + c);
+            threat.placeStone(game, r * N + c);
+            const int newThreat = threat.pathTo(game, threatTarget);
+            const int newOwnPathCost = own.pathTo(game, ownTarget);
+            own.undo();
+            threat.undo();
+            scores[i] = scoreMove(game, player, r, c, context, newThreat, newOwnPathCost);
+        }
+        game.undoMove(r, c);
+    }
+}
+
+void HeuristicAI::playMove(HexGame& game, int r, int c, char player) {
+    game.makeMove(r, c, player);
+    eval.play(game);
+}
+
+void HeuristicAI::takeBack(HexGame& game, int r, int c) {
+    game.undoMove(r, c);
+    eval.undo();
+}
+
+Move HeuristicAI::think(const Position& position, const SearchLimits& limits) {
+    const std::atomic<bool>* savedStop = stop;
+    if (limits.stop) stop = limits.stop;
+    const int savedThreads = threads;
+    if (limits.threads > 0) threads = limits.threads;
+    timeLimitMs = limits.timeMs;
+    clockMs = limits.remainingMs;
+    HexGame work = position;
+    pair<int, int> move = chooseMove(work);
+    stop = savedStop;
+    threads = savedThreads;
+    timeLimitMs = 0;
+    clockMs = 0;
+    return {move.first, move.second};
+}
+
+pair<int, int> HeuristicAI::chooseMove(HexGame& game) {
+    const int N = game.getSize();
+    const char me = sideToMove(game);
+    const char opponent = opponentOf(me);
+    int playerLastR = -1, playerLastC = -1;
+    if (game.lastMove() >= 0) {
+        playerLastR = game.lastMove() / N;
+        playerLastC = game.lastMove() % N;
+    }
+    bool aiFirstMove = !game.stonesOf(me).any();
+
+    int bestR = -1, bestC = -1;
+    int bestScore = -1000000000;
+    eval.reset(game);
+    CellPath& threatPath = context.threatPath;
+    CellPath& ownPath = context.ownPath;
+    threatPath.clear();
+    ownPath.clear();
+    const int threatCost = eval.shortestPath(game, opponent, &threatPath);
+    const int ownPathCost = eval.shortestPath(game, me, &ownPath);
+    context.opponentLastR = playerLastR;
+    context.opponentLastC = playerLastC;
+    context.threatCost = threatCost;
+    context.ownPathCost = ownPathCost;
+    threat.oneMove = threatCost <= 1;
+    threat.twoMoves = threatCost <= 2;
+    // Пустые клетки от своей первой стороны к дальней: с инкрементальным
+    // оценщиком полный перебор дёшев и на больших досках. Заведомо худшие
+    // ходы (inferior.h) отбрасываются — свои и ответы соперника отдельно.
+    const InferiorCells inferior = findInferiorCells(game);
+    timing.start(game, timeLimitMs, clockMs, inferior.movesFor(me).count());
+    emptyCells.clear();
+    replyCells.clear();
+    for (int a = 0; a < N; ++a) {
+        for (int b = 0; b < N; ++b) {
+            auto cell = cellAt(me, a, b);
+            const int idx = cell.first * N + cell.second;
+            if (inferior.movesFor(me).test(idx)) emptyCells.push_back(cell);
+            if (inferior.movesFor(opponent).test(idx)) replyCells.push_back(cell);
+        }
+    }
+    // Если соперник выигрывает за 1 ход, ищем любой блокирующий ход (приоритет пути угрозы).
+    if (bestR == -1 && threatCost <= 1) {
+        // Сначала клетки из критического пути
+        for (const auto& cell : threatPath) {
+            int r = cell.first, c = cell.second;
+            if (!game.isCellEmpty(r, c)) continue;
+            bestR = r; bestC = c; bestScore = 7'000'000;
+            break;
+        }
+        // Если пути нет, перебираем все пустые клетки, которые ломают победу соперника
+        if (bestR == -1) {
+            for (const auto& cell : emptyCells) {
+                int r = cell.first, c = cell.second;
+                playMove(game, r, c, me);
+                bool stillWin = eval.shortestPath(game, opponent) <= 1;
+                takeBack(game, r, c);
+                if (!stillWin) { bestR = r; bestC = c; bestScore = 6'800'000; break; }
+            }
+        }
+    }
+    // Жёстко перекрываем любой конкретный выигрышный ход соперника: если он ставит и выигрывает, ставим туда сами.
+    if (bestR == -1) {
+        for (const auto& cell : emptyCells) {
+            int r = cell.first, c = cell.second;
+            game.makeMove(r, c, opponent);
+            bool opponentWinsHere = game.checkWin(opponent);
+            game.undoMove(r, c);
+            if (opponentWinsHere) {
+                bestR = r; bestC = c; bestScore = 7'200'000;
+                break;
+            }
+        }
+    }
+    // Если на дальнем крае есть клетка, после которой соперник выигрывает, блокируем её немедленно.
+    if (bestR == -1) {
+        for (const auto& cell : emptyCells) {
+            int r = cell.first, c = cell.second;
+            if (alongOf(me, r, c) != N - 1) continue;
+            game.makeMove(r, c, opponent);
+            bool opponentWinFarEdge = game.checkWin(opponent);
+            game.undoMove(r, c);
+            if (opponentWinFarEdge) {
+                bestR = r; bestC = c; bestScore = 6'500'000;
+                break;
+            }
+        }
+    }
+    // Превентивно портим линию соперника по дальнему краю, если там уже много его камней или его путь короткий.
+    if (bestR == -1) {
+        int farEdgeStones = 0;
+        for (int b = 0; b < N; ++b) {
+            auto cell = cellAt(me, N - 1, b);
+            if (game.getCell(cell.first, cell.second) == opponent) farEdgeStones++;
+        }
+        if (farEdgeStones >= N / 3 || threatCost <= 3) {
+            int bestRaise = -1000000000;
+            int bestCenter = 1'000'000;
+            for (const auto& cell : emptyCells) {
+                int r = cell.first, c = cell.second;
+                if (alongOf(me, r, c) != N - 1) continue;
+                playMove(game, r, c, me);
+                int newCost = eval.shortestPath(game, opponent);
+                takeBack(game, r, c);
+                int raise = newCost - threatCost;
+                int centerDist = std::abs(acrossOf(me, r, c) - N / 2);
+                if (raise > bestRaise || (raise == bestRaise && centerDist < bestCenter)) {
+                    bestRaise = raise;
+                    bestCenter = centerDist;
+                    bestR = r; bestC = c;
+                    bestScore = 5'800'000;
+                }
+            }
+        }
+    }
+    if (threatCost <= 2) {
+        if (threatCost <= 1 && !threatPath.empty()) {
+            bestR = threatPath.front().first;
+            bestC = threatPath.front().second;
+            bestScore = 5'000'000;
+        }
+        int bestRaise = -1;
+        int bestCenter = 1'000'000;
+        int bestAlongBias = -1;
+        for (const auto& cell : emptyCells) {
+            int r = cell.first, c = cell.second;
+            playMove(game, r, c, me);
+            int newCost = eval.shortestPath(game, opponent);
+            takeBack(game, r, c);
+            int raise = newCost - threatCost;
+            int along = alongOf(me, r, c);
+            int centerDist = std::abs(r - N / 2) + std::abs(c - N / 2);
+            if (raise > bestRaise ||
+                (raise == bestRaise && along > bestAlongBias) ||
+                (raise == bestRaise && along == bestAlongBias && centerDist < bestCenter)) {
+                bestRaise = raise;
+                bestCenter = centerDist;
+                bestAlongBias = along;
+                bestR = r;
+                bestC = c;
+                bestScore = 4'000'000;
+            }
+        }
+    }
+    // Если путь соперника короткий (<=3), усиливаем перекрытие его минимального пути.
+    if (bestR == -1 && threatCost <= 3 && !threatPath.empty()) {
+        int localBest = -1000000000;
+        evaluateMoves(game, me, threatPath, context, scores, threads, &timing);
+        for (size_t i = 0; i < threatPath.size(); ++i) {
+            if (scores[i] > localBest) {
+                localBest = scores[i];
+                bestR = threatPath[i].first; bestC = threatPath[i].second; bestScore = localBest;
+            }
+        }
+    }
+    if (bestR == -1) {
+        // Первый ход ИИ — в центр или в ближайшую точку своего кратчайшего пути.
+        if (aiFirstMove) {
+            int center = N / 2;
+            if (game.isCellEmpty(center, center)) {
+                bestR = center;
+                bestC = center;
+                bestScore = 3'500'000;
+            } else if (!ownPath.empty()) {
+                bestR = ownPath.front().first;
+                bestC = ownPath.front().second;
+                bestScore = 3'400'000;
+            }
+            aiFirstMove = false;
+        }
+        if (bestR == -1) {
+            // Минимакс глубиной 2: свой ход -> ответ соперника -> оценка
+            auto evalState = [this, &game, me, opponent]() -> int {
+                int opponentCost = eval.shortestPath(game, opponent);
+                int ownCost = eval.shortestPath(game, me);
+                int score = 0;
+                score += (50 - std::min(50, ownCost)) * 30000;
+                score -= (50 - std::min(50, opponentCost)) * 32000;
+                return score;
+            };
+            auto buildReplyCands = [&](CellPath& replies) {
+                replies.clear();
+                std::vector<Candidate>& tmp = replyOrder;
+                tmp.clear();
+                for (const auto& cell : replyCells) {
+                    int r = cell.first, c = cell.second;
+                    int along = alongOf(me, r, c);
+                    int bias = 0;
+                    if (along >= N - 2) bias += 400;
+                    if (along == N - 1) bias += 800;
+                    int centerDist = std::abs(r - N/2) + std::abs(c - N/2);
+                    bias -= centerDist * 5;
+                    tmp.push_back({bias, r, c});
+                }
+                std::sort(tmp.begin(), tmp.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+                int lim = std::min<int>(12, tmp.size());
+                for (int i = 0; i < lim; ++i) replies.push_back({tmp[i].r, tmp[i].c});
+            };
+
+            ownCands.clear();
+            for (const auto& cell : ownPath) {
+                if (game.isCellEmpty(cell.first, cell.second))
+                    ownCands.push_back({300, cell.first, cell.second});
+            }
+            for (const auto& cell : emptyCells) {
+                int r = cell.first, c = cell.second;
+                int along = alongOf(me, r, c);
+                int quick = 0;
+                if (along >= N - 2) quick += 200;
+                if (along == N - 1) quick += 400;
+                int centerDist = std::abs(r - N/2) + std::abs(c - N/2);
+                quick -= centerDist * 3;
+                ownCands.push_back({quick, r, c});
+            }
+            std::sort(ownCands.begin(), ownCands.end(), [](const Candidate& a, const Candidate& b){ return a.score > b.score; });
+            int ownLim = std::min<int>(18, ownCands.size());
+
+            int globalBest = -2000000000;
+            int chosenR = -1, chosenC = -1;
+
+            for (int idx = 0; idx < ownLim && !stopped() && !outOfTime(); ++idx) {
+                int r = ownCands[idx].r;
+                int c = ownCands[idx].c;
+                if (!game.isCellEmpty(r, c)) continue;
+                playMove(game, r, c, me);
+                if (game.checkWin(me)) {
+                    takeBack(game, r, c);
+                    bestR = r; bestC = c; bestScore = 100000000;
+                    break;
+                }
+                int worstForMe = 2000000000;
+                buildReplyCands(replyCandidates);
+                if (replyCandidates.empty()) {
+                    worstForMe = evalState();
+                } else {
+                    for (const auto& reply : replyCandidates) {
+                        int rr = reply.first, rc = reply.second;
+                        // Ответы собраны до нашего хода и могут совпасть с ним.
+                        if (!game.isCellEmpty(rr, rc)) continue;
+                        playMove(game, rr, rc, opponent);
+                        if (game.checkWin(opponent)) {
+                            worstForMe = std::min(worstForMe, -100000000);
+                        } else {
+                            int s = evalState();
+                            worstForMe = std::min(worstForMe, s);
+                        }
+                        takeBack(game, rr, rc);
+                    }
+                }
+                takeBack(game, r, c);
+                if (worstForMe > globalBest) {
+                    globalBest = worstForMe;
+                    chosenR = r; chosenC = c;
+                }
+            }
+
+            if (bestR == -1 && chosenR != -1) {
+                bestR = chosenR; bestC = chosenC; bestScore = globalBest;
+            }
+        }
+        if (bestR == -1) {
+            topMoves.clear();
+            for (const auto& cell : emptyCells) {
+                int r = cell.first, c = cell.second;
+                int quickScore = 0;
+                int along = alongOf(me, r, c);
+                if (std::abs(r - playerLastR) + std::abs(c - playerLastC) <= 2) quickScore += 1000;
+                if (along == 0 || along == N-1) quickScore += 500;
+                topMoves.push_back({quickScore, r, c});
+                game.makeMove(r, c, me);
+                if (game.checkWin(me)) {
+                    bestR = r; bestC = c; bestScore = 5000000;
+                    game.undoMove(r, c);
+                    break;
+                }
+                game.undoMove(r, c);
+            }
+            int limit = std::min<int>(20, static_cast<int>(topMoves.size()));
+            topCells.clear();
+            for (int i = 0; i < limit; ++i) topCells.push_back({topMoves[i].r, topMoves[i].c});
+            if (!stopped() && !outOfTime()) {
+                evaluateMoves(game, me, topCells, context, scores, threads, &timing);
+                for (int i = 0; i < limit; ++i) {
+                    if (scores[i] > bestScore) {
+                        bestScore = scores[i];
+                        bestR = topCells[i].first;
+                        bestC = topCells[i].second;
+                    }
+                }
+            }
+        }
+    }
+    if (bestR == -1 && !ownPath.empty() && !outOfTime()) {
+        int localBestScore = -1000000000;
+        evaluateMoves(game, me, ownPath, context, scores, threads, &timing);
+        for (size_t i = 0; i < ownPath.size(); ++i) {
+            if (scores[i] > localBestScore) {
+                localBestScore = scores[i];
+                bestR = ownPath[i].first;
+                bestC = ownPath[i].second;
+            }
+        }
+        if (bestR != -1) bestScore = localBestScore;
+    }
+    if (stopped()) return {-1, -1};
+    // Срок вышел раньше любой оценки: ход с кратчайшего пути или первая
+    // разумная клетка.
+    if (bestR == -1) {
+        for (const auto& cell : ownPath) {
+            if (!game.isCellEmpty(cell.first, cell.second)) continue;
+            bestR = cell.first; bestC = cell.second;
+            break;
+        }
+    }
+    if (bestR == -1 && !emptyCells.empty()) {
+        bestR = emptyCells.front().first;
+        bestC = emptyCells.front().second;
+    }
+    return {bestR, bestC};
+}
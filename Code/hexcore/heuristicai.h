@@ -0,0 +1,108 @@
+#ifndef HEXCORE_HEURISTICAI_H
+#define HEXCORE_HEURISTICAI_H
+
+#include "engine.h"
+#include "evaluator.h"
+#include "hexgame.h"
+#include "timemanager.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Эвристический ИИ из Qt-версии: блокирует кратчайший путь соперника и
+// строит свой, с неглубоким перебором свой ход -> ответ -> оценка. Играет
+// за сторону, чей ход в позиции; эвристики записаны относительно
+// направления соединения, поэтому одинаковы для X и O. Пути в переборе
+// обновляются инкрементально через HexEvaluator. Работает с переданной
+// копией позиции, поэтому может искать в фоне. С пределом времени из
+// think к жёсткому сроку возвращается лучший ход из уже оценённых.
+class HeuristicAI : public Engine {
+public:
+    // Результат последнего chooseMove: насколько близок к победе соперник.
+    struct Threat {
+        bool oneMove = false;
+        bool twoMoves = false;
+    };
+
+    // Общие для всех кандидатов данные оценки: последний ход соперника и
+    // кратчайшие пути обоих игроков до хода.
+    struct MoveContext {
+        int opponentLastR = -1;
+        int opponentLastC = -1;
+        int threatCost = kNoPath;
+        CellPath threatPath;
+        int ownPathCost = kNoPath;
+        CellPath ownPath;
+    };
+
+    // Флаг проверяется между кандидатами; при остановке возвращается (-1, -1).
+    void setStopFlag(const std::atomic<bool>* flag) { stop = flag; }
+    // Потоки для пакетной оценки кандидатов в chooseMove.
+    void setThreads(int count) { threads = count; }
+
+    std::pair<int, int> chooseMove(HexGame& game);
+    Move think(const Position& position, const SearchLimits& limits) override;
+    const Threat& lastThreat() const { return threat; }
+
+    static int minMovesToWin(const HexGame& game, char player, CellPath* path = nullptr);
+    static bool isOneMoveFromWin(const HexGame& game, char player);
+    static bool isTwoMovesFromWin(const HexGame& game, char player);
+    static int shortestPathToConnect(const HexGame& game, char player, int r, int c);
+    // game уже содержит камень player на (r, c).
+    static int evaluateMove(HexGame& game, char player, int r, int c, int opponentLastR, int opponentLastC,
+                            int baseThreatCost, const CellPath& threatPath,
+                            int baseOwnPathCost, const CellPath& ownPath);
+    // Оценки evaluateMove для ходов player из moves в позиции game, где их
+    // ещё нет; занятые клетки получают -kNoPath. Поля расстояний считаются
+    // один раз и для каждого хода обновляются инкрементально, буферы свои
+    // у каждого потока. При threads > 1 ходы делятся между потоками.
+    // После жёсткого срока timing ходы не оцениваются и остаются с -kNoPath.
+    static std::vector<int> evaluateMoves(const HexGame& game, char player, const CellPath& moves,
+                                          const MoveContext& context, int threads = 1,
+                                          const TimeManager* timing = nullptr);
+    // То же в готовый буфер; в одном потоке без выделения памяти.
+    static void evaluateMoves(const HexGame& game, char player, const CellPath& moves,
+                              const MoveContext& context, std::vector<int>& scores, int threads = 1,
+                              const TimeManager* timing = nullptr);
+
+private:
+    struct Candidate {
+        int score;
+        int r;
+        int c;
+    };
+
+    static int scoreMove(const HexGame& game, char player, int r, int c, const MoveContext& context,
+                         int newThreat, int newOwnPathCost);
+    static void evaluateSlice(const HexGame& base, char player, const CellPath& moves, const MoveContext& context,
+                              DistanceField* fields, int* scores, size_t first, size_t step,
+                              const TimeManager* timing);
+
+    bool stopped() const { return stop && stop->load(std::memory_order_relaxed); }
+    bool outOfTime() const { return timing.hardExpired(); }
+
+    // Ход на копии позиции с обновлением оценщика и его откат.
+    void playMove(HexGame& game, int r, int c, char player);
+    void takeBack(HexGame& game, int r, int c);
+
+    const std::atomic<bool>* stop = nullptr;
+    int threads = 1;
+    int timeLimitMs = 0;              // предел на ход из think; 0 — без предела
+    int clockMs = 0;                  // остаток часов на партию
+    TimeManager timing;
+    Threat threat;
+    HexEvaluator eval;
+    // Буферы chooseMove сохраняют ёмкость между ходами.
+    MoveContext context;
+    CellPath emptyCells;
+    CellPath replyCells;
+    CellPath replyCandidates;
+    CellPath topCells;
+    std::vector<Candidate> ownCands;
+    std::vector<Candidate> replyOrder;
+    std::vector<Candidate> topMoves;
+    std::vector<int> scores;
+};
+
+#endif // HEXCORE_HEURISTICAI_H
@@ -0,0 +1,169 @@
+#include "hexgame.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// Соседи по кругу: порядок важен для локальных шаблонов вокруг клетки.
+const int kHexDirections[6][2] = {
+    {-1, 0}, {-1, 1}, {0, 1},
+    {1, 0}, {1, -1}, {0, -1}
+};
+
+void buildGeometry(BoardGeometry& g, int size) {
+    g.size = size;
+    g.cells = size * size;
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            int idx = r * size + c;
+            g.all.set(idx);
+            if (c == 0) g.edge[kEdgeLeft].set(idx);
+            if (c == size - 1) g.edge[kEdgeRight].set(idx);
+            if (r == 0) g.edge[kEdgeTop].set(idx);
+            if (r == size - 1) g.edge[kEdgeBottom].set(idx);
+            for (int d = 0; d < 6; ++d) {
+                int nr = r + kHexDirections[d][0];
+                int nc = c + kHexDirections[d][1];
+                bool inside = nr >= 0 && nr < size && nc >= 0 && nc < size;
+                g.neighbors[idx][d] = static_cast<int16_t>(inside ? nr * size + nc : -1);
+            }
+        }
+    }
+}
+
+} // namespace
+
+const BoardGeometry& boardGeometry(int size) {
+    static const auto table = [] {
+        auto* t = new std::array<BoardGeometry, kMaxBoardSize + 1>();
+        for (int n = 1; n <= kMaxBoardSize; ++n) buildGeometry((*t)[n], n);
+        return t;
+    }();
+    return (*table)[std::clamp(size, 1, kMaxBoardSize)];
+}
+
+HexGame::HexGame(int n, bool swapRule)
+    : geo(&boardGeometry(n)), size(geo->size), filled(0), wonMask(0), swapRule(swapRule), swapped(false),
+      hashKey(0), rotatedKey(0), unionTop(0) {
+    for (int v = 0; v < geo->cells + 4; ++v) {
+        parent[v] = static_cast<int16_t>(v);
+        setSize[v] = 1;
+    }
+}
+
+bool HexGame::makeMove(int r, int c, char player) {
+    if (!inBounds(r, c)) return false;
+    int idx = r * size + c;
+    if (occupied().test(idx)) return false;
+    int color = colorIndex(player);
+    stones[color].set(idx);
+    hashKey ^= kZobrist.stone[color][idx];
+    rotatedKey ^= kZobrist.stone[color][geo->cells - 1 - idx];
+    moveCell[filled] = static_cast<int16_t>(idx);
+    moveLogMark[filled] = static_cast<int16_t>(unionTop);
+    ++filled;
+    connectStone(idx, color);
+    updateWinner(color);
+    return true;
+}
+
+void HexGame::undoMove(int r, int c) {
+    if (!inBounds(r, c)) return;
+    int idx = r * size + c;
+    if (!occupied().test(idx)) return;
+    const int color = stones[1].test(idx) ? 1 : 0;
+    hashKey ^= kZobrist.stone[color][idx];
+    rotatedKey ^= kZobrist.stone[color][geo->cells - 1 - idx];
+    stones[0].reset(idx);
+    stones[1].reset(idx);
+
+    if (filled == 1) swapped = false;
+    if (moveCell[filled - 1] == idx) {
+        --filled;
+        while (unionTop > moveLogMark[filled]) {
+            int child = unionLog[--unionTop];
+            int root = parent[child];
+            setSize[root] = static_cast<int16_t>(setSize[root] - setSize[child]);
+            parent[child] = static_cast<int16_t>(child);
+        }
+        wonMask = 0;
+        updateWinner(0);
+        updateWinner(1);
+        return;
+    }
+
+    int pos = 0;
+    while (moveCell[pos] != idx) ++pos;
+    for (int k = pos + 1; k < filled; ++k) moveCell[k - 1] = moveCell[k];
+    --filled;
+    rebuildConnectivity();
+}
+
+bool HexGame::swapSides() {
+    if (!canSwap()) return false;
+    const int idx = moveCell[0];
+    undoMove(idx / size, idx % size);
+    makeMove(idx % size, idx / size, 'O');
+    swapped = true;
+    return true;
+}
+
+void HexGame::undoSwap() {
+    if (!swapped || filled != 1) return;
+    const int idx = moveCell[0];
+    undoMove(idx / size, idx % size);
+    makeMove(idx % size, idx / size, 'X');
+}
+
+void HexGame::unite(int a, int b) {
+    int ra = findRoot(a);
+    int rb = findRoot(b);
+    if (ra == rb) return;
+    if (setSize[ra] < setSize[rb]) std::swap(ra, rb);
+    parent[rb] = static_cast<int16_t>(ra);
+    setSize[ra] = static_cast<int16_t>(setSize[ra] + setSize[rb]);
+    unionLog[unionTop++] = static_cast<int16_t>(rb);
+}
+
+void HexGame::connectStone(int idx, int color) {
+    const Bitboard& own = stones[color];
+    for (int nb : geo->neighbors[idx]) {
+        if (nb >= 0 && own.test(nb)) unite(idx, nb);
+    }
+    const int cells = geo->cells;
+    const HexEdge from = color == 0 ? kEdgeLeft : kEdgeTop;
+    const HexEdge to = color == 0 ? kEdgeRight : kEdgeBottom;
+    if (geo->edge[from].test(idx)) unite(idx, cells + from);
+    if (geo->edge[to].test(idx)) unite(idx, cells + to);
+}
+
+void HexGame::updateWinner(int color) {
+    const int cells = geo->cells;
+    const int from = cells + (color == 0 ? kEdgeLeft : kEdgeTop);
+    const int to = cells + (color == 0 ? kEdgeRight : kEdgeBottom);
+    if (findRoot(from) == findRoot(to)) wonMask |= static_cast<uint8_t>(1u << color);
+}
+
+void HexGame::rebuildConnectivity() {
+    for (int v = 0; v < geo->cells + 4; ++v) {
+        parent[v] = static_cast<int16_t>(v);
+        setSize[v] = 1;
+    }
+    unionTop = 0;
+    wonMask = 0;
+    // Камни расставляются заново в порядке ходов, чтобы журнал снова
+    // допускал откат последнего хода.
+    const Bitboard placed[2] = {stones[0], stones[1]};
+    stones[0].clear();
+    stones[1].clear();
+    for (int k = 0; k < filled; ++k) {
+        int idx = moveCell[k];
+        int color = placed[0].test(idx) ? 0 : 1;
+        stones[color].set(idx);
+        moveLogMark[k] = static_cast<int16_t>(unionTop);
+        connectStone(idx, color);
+    }
+    updateWinner(0);
+    updateWinner(1);
+}
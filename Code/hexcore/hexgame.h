@@ -0,0 +1,115 @@
+#ifndef HEXCORE_HEXGAME_H
+#define HEXCORE_HEXGAME_H
+
+#include "bitboard.h"
+#include "zobrist.h"
+
+#include <cstdint>
+
+// X соединяет левую и правую стороны, O — верхнюю и нижнюю.
+enum HexEdge { kEdgeLeft = 0, kEdgeRight = 1, kEdgeTop = 2, kEdgeBottom = 3 };
+
+inline int colorIndex(char player) { return player == 'O' ? 1 : 0; }
+inline char opponentOf(char player) { return player == 'X' ? 'O' : 'X'; }
+
+// Соседи клеток и маски сторон для доски заданного размера.
+// Таблицы строятся один раз на все размеры и разделяются всеми позициями.
+struct BoardGeometry {
+    int size = 0;
+    int cells = 0;
+    int16_t neighbors[kMaxCells][6];   // -1 за пределами доски
+    Bitboard all;
+    Bitboard edge[4];
+};
+
+const BoardGeometry& boardGeometry(int size);
+
+class HexGame {
+public:
+    explicit HexGame(int size, bool swapRule = false);
+
+    bool makeMove(int r, int c, char player);
+
+    // Правило обмена: после первого хода X соперник может вместо ответа
+    // забрать этот ход себе. Камень X заменяется камнем O, отражённым
+    // относительно главной диагонали, и снова ходит X.
+    bool hasSwapRule() const { return swapRule; }
+    bool canSwap() const { return swapRule && filled == 1 && !swapped; }
+    bool isSwapped() const { return swapped; }
+    bool swapSides();
+    void undoSwap();
+
+    // Отмена последнего хода — откат журнала объединений. Отмена более раннего
+    // хода тоже поддерживается, но перестраивает связность заново.
+    void undoMove(int r, int c);
+
+    bool inBounds(int r, int c) const {
+        return static_cast<unsigned>(r) < static_cast<unsigned>(size) &&
+               static_cast<unsigned>(c) < static_cast<unsigned>(size);
+    }
+
+    bool isCellEmpty(int r, int c) const {
+        return inBounds(r, c) && !occupied().test(r * size + c);
+    }
+
+    char getCell(int r, int c) const {
+        if (!inBounds(r, c)) return '#';
+        int idx = r * size + c;
+        if (stones[0].test(idx)) return 'X';
+        if (stones[1].test(idx)) return 'O';
+        return '.';
+    }
+
+    // Связность ведётся инкрементально, поэтому проверка победы — чтение флага.
+    bool checkWin(char player) const { return (wonMask >> colorIndex(player)) & 1u; }
+    bool isFull() const { return filled == geo->cells; }
+
+    int getSize() const { return size; }
+    int moveCount() const { return filled; }
+    int lastMove() const { return filled > 0 ? moveCell[filled - 1] : -1; }   // индекс клетки или -1
+    int moveAt(int k) const { return moveCell[k]; }
+    uint64_t hash() const { return hashKey; }   // Zobrist, ведётся в makeMove/undoMove
+    // Поворот на 180° сохраняет стороны обоих игроков, поэтому позиция и её
+    // повёрнутая копия равноценны. Канонический хэш — меньший из двух;
+    // canonicalRotated() говорит, что клетки канонической формы повёрнуты.
+    uint64_t canonicalHash() const { return hashKey < rotatedKey ? hashKey : rotatedKey; }
+    bool canonicalRotated() const { return rotatedKey < hashKey; }
+    const BoardGeometry& geometry() const { return *geo; }
+    const Bitboard& stonesOf(char player) const { return stones[colorIndex(player)]; }
+    Bitboard occupied() const { return stones[0] | stones[1]; }
+    Bitboard emptyCells() const { return geo->all.andNot(occupied()); }
+
+private:
+    // Узлы системы непересекающихся множеств: клетки 0..cells-1 и четыре
+    // виртуальных узла сторон cells + HexEdge. Объединение по размеру без
+    // сжатия путей, чтобы каждое объединение откатывалось одной записью.
+    static constexpr int kMaxNodes = kMaxCells + 4;
+
+    int findRoot(int v) const {
+        while (parent[v] != v) v = parent[v];
+        return v;
+    }
+    void unite(int a, int b);
+    void connectStone(int idx, int color);
+    void updateWinner(int color);
+    void rebuildConnectivity();
+
+    const BoardGeometry* geo;
+    int size;
+    int filled;
+    uint8_t wonMask;
+    bool swapRule;
+    bool swapped;
+    uint64_t hashKey;
+    uint64_t rotatedKey;             // хэш позиции, повёрнутой на 180°
+    Bitboard stones[2];
+
+    int16_t parent[kMaxNodes];
+    int16_t setSize[kMaxNodes];
+    int16_t unionLog[kMaxNodes];     // корни, присоединённые к другому множеству
+    int unionTop;
+    int16_t moveCell[kMaxCells];     // клетки в порядке ходов
+    int16_t moveLogMark[kMaxCells];  // unionTop перед каждым ходом
+};
+
+#endif // HEXCORE_HEXGAME_H
@@ -0,0 +1,299 @@
+#include "hsearch.h"
+
+#include "engine.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Проверка часов — раз в столько шагов правила И.
+constexpr size_t kClockCheckSteps = 256;
+
+// Ключ кэша решателя: хэш позиции и сторона, которая ходит.
+constexpr uint64_t kSideSalt = 0x30000;
+
+} // namespace
+
+const ArenaVector<Connection>& HSearch::edgeVcs() const {
+    if (nodes == 0 || slotOf[edgeA * nodes + edgeB] < 0) return none;
+    return pairs[slotOf[edgeA * nodes + edgeB]].vcs;
+}
+
+const ArenaVector<Connection>& HSearch::edgeScs() const {
+    if (nodes == 0 || slotOf[edgeA * nodes + edgeB] < 0) return none;
+    return pairs[slotOf[edgeA * nodes + edgeB]].scs;
+}
+
+int HSearch::pairSlot(int a, int b) {
+    if (a > b) std::swap(a, b);
+    int& slot = slotOf[a * nodes + b];
+    if (slot < 0) {
+        slot = static_cast<int>(pairs.size());
+        pairs.emplace_back(arena);
+        partners[a].push_back(b);
+        partners[b].push_back(a);
+    }
+    return slot;
+}
+
+bool HSearch::overBudget() {
+    if (outOfBudget) return true;
+    if (connections > budget.maxConnections) {
+        outOfBudget = true;
+    } else if (++steps % kClockCheckSteps == 0 && std::chrono::steady_clock::now() >= budget.deadline) {
+        outOfBudget = true;
+    }
+    return outOfBudget;
+}
+
+void HSearch::run(const HexGame& game, char player, const Budget& b) {
+    const BoardGeometry& geo = game.geometry();
+    budget = b;
+    cells = geo.cells;
+    nodes = cells + 2;
+    edgeA = cells;
+    edgeB = cells + 1;
+    own = game.stonesOf(player);
+    const Bitboard enemy = game.stonesOf(opponentOf(player));
+    outOfBudget = false;
+    done = false;
+    connections = 0;
+    steps = 0;
+    slotOf.assign(static_cast<size_t>(nodes) * nodes, -1);
+    // Прежние пары уходят вместе с ареной: контейнеры заменяются пустыми,
+    // чтобы не держать её память после reset.
+    pairs = ArenaVector<PairConnections>(ArenaAllocator<PairConnections>(arena));
+    partners = ArenaVector<ArenaVector<int>>(ArenaAllocator<ArenaVector<int>>(arena));
+    arena.reset();
+    for (int i = 0; i < nodes; ++i) partners.emplace_back(ArenaAllocator<int>(arena));
+    queue.clear();
+    queueHead = 0;
+
+    // Группа своих камней — один узел: её представитель, первый камень обхода.
+    std::vector<int>& node = nodeOf;
+    node.assign(cells, -1);
+    stack.clear();
+    stack.reserve(cells);
+    own.forEach([&](int start) {
+        if (node[start] >= 0) return;
+        node[start] = start;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int v = stack.back();
+            stack.pop_back();
+            for (int nb : geo.neighbors[v]) {
+                if (nb >= 0 && own.test(nb) && node[nb] < 0) {
+                    node[nb] = start;
+                    stack.push_back(nb);
+                }
+            }
+        }
+    });
+    game.emptyCells().forEach([&](int idx) { node[idx] = idx; });
+
+    // Базовые соединения с пустым носителем: соседство и касание стороны.
+    const Bitboard& sideA = geo.edge[2 * colorIndex(player)];
+    const Bitboard& sideB = geo.edge[2 * colorIndex(player) + 1];
+    const Bitboard empty;
+    for (int idx = 0; idx < cells; ++idx) {
+        if (enemy.test(idx)) continue;
+        const int u = node[idx];
+        for (int nb : geo.neighbors[idx]) {
+            if (nb > idx && !enemy.test(nb) && node[nb] != u) addVc(u, node[nb], empty);
+        }
+        if (sideA.test(idx)) addVc(u, edgeA, empty);
+        if (sideB.test(idx)) addVc(u, edgeB, empty);
+    }
+
+    while (queueHead < queue.size() && !done && !overBudget()) {
+        Pending vc = queue[queueHead++];   // очередь растёт внутри andRule
+        andRule(vc);
+    }
+}
+
+void HSearch::addVc(int a, int b, const Bitboard& carrier) {
+    if (a == b) return;
+    const int slot = pairSlot(a, b);
+    ArenaVector<Connection>& vcs = pairs[slot].vcs;
+    for (const Connection& c : vcs) {
+        if (c.carrier.isSubsetOf(carrier)) return;
+    }
+    vcs.erase(std::remove_if(vcs.begin(), vcs.end(),
+                             [&](const Connection& c) { return carrier.isSubsetOf(c.carrier); }),
+              vcs.end());
+    if (static_cast<int>(vcs.size()) >= budget.maxVcs) return;
+    vcs.push_back({carrier, -1});
+    ++connections;
+    queue.push_back({a, b, carrier});
+    if (std::min(a, b) == edgeA && std::max(a, b) == edgeB) done = true;
+}
+
+void HSearch::addSc(int a, int b, const Bitboard& carrier, int key) {
+    if (a == b) return;
+    const int slot = pairSlot(a, b);
+    PairConnections& pc = pairs[slot];
+    for (const Connection& c : pc.vcs) {
+        if (c.carrier.isSubsetOf(carrier)) return;
+    }
+    for (const Connection& c : pc.scs) {
+        if (c.carrier.isSubsetOf(carrier)) return;
+    }
+    if (static_cast<int>(pc.scs.size()) >= budget.maxScs) return;
+    pc.scs.push_back({carrier, key});
+    ++connections;
+    if (budget.stopOnEdgeSc && std::min(a, b) == edgeA && std::max(a, b) == edgeB) {
+        done = true;
+        return;
+    }
+
+    // Копия: addVc ниже может перераспределить хранилище пар.
+    orScs.assign(pc.scs.begin(), pc.scs.end());
+    orRule(a, b, orScs, carrier, carrier, orScs.size() - 1, 1);
+}
+
+// Новое полусоединение объединяется с набором прежних; пустое пересечение
+// носителей значит, что соперник не разрушит все сразу.
+bool HSearch::orRule(int a, int b, const std::vector<Connection>& scs, const Bitboard& intersection,
+                     const Bitboard& carrier, size_t end, int depth) {
+    for (size_t i = 0; i < end; ++i) {
+        Bitboard common = intersection;
+        common &= scs[i].carrier;
+        Bitboard joined = carrier;
+        joined |= scs[i].carrier;
+        if (!common.any()) {
+            addVc(a, b, joined);
+            return true;
+        }
+        if (depth + 1 < budget.orDepth && orRule(a, b, scs, common, joined, i, depth + 1)) return true;
+    }
+    return false;
+}
+
+// Правило И: соединения x-z и z-w с непересекающимися носителями. Через
+// камень или сторону получается соединение x-w, через пустую клетку z —
+// полусоединение с ключом z.
+void HSearch::andRule(const Pending& vc) {
+    for (int side = 0; side < 2; ++side) {
+        const int z = side ? vc.b : vc.a;
+        const int other = side ? vc.a : vc.b;
+        const bool throughStone = isStoneOrEdge(z);
+        for (size_t p = 0; p < partners[z].size(); ++p) {
+            const int w = partners[z][p];
+            if (w == other || (isCell(w) && vc.carrier.test(w))) continue;
+            const int slot = slotOf[std::min(z, w) * nodes + std::max(z, w)];
+            for (size_t i = 0; i < pairs[slot].vcs.size(); ++i) {
+                Bitboard joined = pairs[slot].vcs[i].carrier;
+                if (joined.intersects(vc.carrier) || (isCell(other) && joined.test(other))) continue;
+                joined |= vc.carrier;
+                if (throughStone) {
+                    addVc(other, w, joined);
+                } else {
+                    joined.set(z);
+                    addSc(other, w, joined, z);
+                }
+                if (done || overBudget()) return;
+            }
+        }
+    }
+}
+
+VcSolver::VcSolver(SolverLimits limits) : limits(limits) {
+}
+
+void VcSolver::clearCache() {
+    for (CacheSlot& slot : cache) slot.key = 0;
+}
+
+HSearch::Budget VcSolver::budgetUntil(std::chrono::steady_clock::time_point deadline) const {
+    HSearch::Budget budget;
+    budget.deadline = deadline;
+    // Половина памяти — на соединения поиска: носитель в хранилище и в очереди.
+    budget.maxConnections = limits.memoryMb * 1024 * 1024 / 2 / (sizeof(Connection) + sizeof(Bitboard) + 8);
+    return budget;
+}
+
+int VcSolver::pickWinningMove(const HexGame& game, const HSearch& found) const {
+    const ArenaVector<Connection>& scs = found.edgeScs();
+    if (!scs.empty() && (found.edgeVcs().empty() || !found.edgeVcs().front().carrier.any())) {
+        const Connection* best = &scs.front();
+        for (const Connection& c : scs) {
+            if (c.carrier.count() < best->carrier.count()) best = &c;
+        }
+        return best->key;
+    }
+
+    // Соединение уже есть: любой ход из носителя его сохраняет, соперник
+    // на него ответить не успел. Берётся самый узкий носитель.
+    const Connection* best = &found.edgeVcs().front();
+    for (const Connection& c : found.edgeVcs()) {
+        if (c.carrier.count() < best->carrier.count()) best = &c;
+    }
+    int move = -1;
+    const Bitboard& from = best->carrier.any() ? best->carrier : game.emptyCells();
+    from.forEach([&](int idx) {
+        if (move < 0) move = idx;
+    });
+    return move;
+}
+
+SolveResult VcSolver::solve(const HexGame& game) {
+    const auto start = std::chrono::steady_clock::now();
+    stats = SolverStats();
+    SolveResult result;
+    if (game.checkWin('X') || game.checkWin('O') || game.isFull()) return result;
+
+    const char me = sideToMove(game);
+    const char opp = opponentOf(me);
+    const uint64_t key = game.hash() ^ mixKey(kSideSalt + colorIndex(me));
+    if (cache.empty()) {
+        // Половина памяти — на кэш; число слотов — степень двойки.
+        size_t count = 1;
+        while (count * 2 * sizeof(CacheSlot) <= limits.memoryMb * 1024 * 1024 / 2) count *= 2;
+        cache.resize(count);
+    }
+    CacheSlot& slot = cache[key & (cache.size() - 1)];
+    if (slot.key == key) {
+        ++stats.cacheHits;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return slot.result;
+    }
+
+    const auto deadline = start + std::chrono::milliseconds(limits.timeMs);
+    const auto half = start + std::chrono::milliseconds(limits.timeMs / 2);
+
+    // Своё полусоединение сторон — выигрыш: ход за нами.
+    HSearch::Budget budget = budgetUntil(half);
+    budget.stopOnEdgeSc = true;
+    search.run(game, me, budget);
+    stats.connections += search.connectionCount();
+    stats.exhausted = search.exhausted();
+    if (search.edgesConnected() || !search.edgeScs().empty()) {
+        result.status = kSolveWin;
+        result.move = pickWinningMove(game, search);
+    } else {
+        // Соединение соперника — проигрыш при любом ходе; его полусоединения
+        // надо разрушать, и ход обязан попасть в пересечение их носителей.
+        search.run(game, opp, budgetUntil(deadline));
+        stats.connections += search.connectionCount();
+        stats.exhausted = stats.exhausted || search.exhausted();
+        if (search.edgesConnected()) {
+            result.status = kSolveLoss;
+        } else if (!search.edgeScs().empty()) {
+            Bitboard must = game.emptyCells();
+            for (const Connection& c : search.edgeScs()) must &= c.carrier;
+            if (must.any()) result.mustPlay = must;
+            else result.status = kSolveLoss;
+        }
+    }
+
+    // Оборванный бюджетом поиск в кэш не идёт: с большим бюджетом та же
+    // позиция может решиться. Найденное соединение — доказательство при
+    // любом бюджете.
+    if (!stats.exhausted || result.status != kSolveUnknown) {
+        slot.key = key;
+        slot.result = result;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
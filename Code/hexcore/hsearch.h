@@ -0,0 +1,150 @@
+#ifndef HEXCORE_HSEARCH_H
+#define HEXCORE_HSEARCH_H
+
+#include "hexgame.h"
+#include "scratch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Виртуальное соединение двух узлов: игрок соединит их, даже если соперник
+// ходит первым, используя только клетки carrier. Полусоединению нужен ещё
+// один свой ход — в клетку key, которая входит в carrier.
+struct Connection {
+    Bitboard carrier;
+    int key = -1;           // -1 у полных соединений
+};
+
+// H-search (Аншелевич) для одного игрока. Узлы — пустые клетки, группы
+// своих камней и две свои стороны; камни соперника в поиск не входят.
+// Соединения выводятся правилом И (через общий узел: через камень или
+// сторону — соединение, через пустую клетку — полусоединение) и правилом
+// ИЛИ (полусоединения с пустым пересечением носителей дают соединение).
+// Соединения пар лежат в арене, которую run сбрасывает; остальные буферы
+// сохраняют ёмкость. После первых поисков новые поиски не выделяют память,
+// пока не превысят прежний размер.
+class HSearch {
+public:
+    struct Budget {
+        std::chrono::steady_clock::time_point deadline;
+        size_t maxConnections = 200000;
+        int maxVcs = 8;         // на пару узлов
+        int maxScs = 12;
+        int orDepth = 4;        // сколько полусоединений объединяет правило ИЛИ
+        bool stopOnEdgeSc = false;  // хватит полусоединения сторон: игрок ходит сам
+    };
+
+    void run(const HexGame& game, char player, const Budget& budget);
+
+    // Соединение сторон: игрок выиграл бы, даже если ходит соперник.
+    bool edgesConnected() const { return !edgeVcs().empty(); }
+    const ArenaVector<Connection>& edgeVcs() const;
+    const ArenaVector<Connection>& edgeScs() const;
+
+    bool exhausted() const { return outOfBudget; }
+    size_t connectionCount() const { return connections; }
+
+private:
+    struct PairConnections {
+        explicit PairConnections(ScratchArena& arena)
+            : vcs(ArenaAllocator<Connection>(arena)), scs(ArenaAllocator<Connection>(arena)) {}
+
+        ArenaVector<Connection> vcs;
+        ArenaVector<Connection> scs;
+    };
+    struct Pending {
+        int a;
+        int b;
+        Bitboard carrier;
+    };
+
+    int pairSlot(int a, int b);
+    bool isCell(int node) const { return node < cells; }
+    bool isStoneOrEdge(int node) const { return node >= cells || own.test(node); }
+    void addVc(int a, int b, const Bitboard& carrier);
+    void addSc(int a, int b, const Bitboard& carrier, int key);
+    bool orRule(int a, int b, const std::vector<Connection>& scs, const Bitboard& intersection,
+                const Bitboard& carrier, size_t end, int depth);
+    void andRule(const Pending& vc);
+    bool overBudget();
+
+    int cells = 0;
+    int nodes = 0;
+    int edgeA = 0;
+    int edgeB = 0;
+    Bitboard own;
+    Budget budget;
+    bool outOfBudget = false;
+    bool done = false;
+    size_t connections = 0;
+    size_t steps = 0;
+    ScratchArena arena;
+    std::vector<int> slotOf;                  // пара узлов -> индекс в pairs
+    ArenaVector<PairConnections> pairs{ArenaAllocator<PairConnections>(arena)};
+    ArenaVector<ArenaVector<int>> partners{ArenaAllocator<ArenaVector<int>>(arena)};  // узлы, с которыми уже есть соединение
+    std::vector<Pending> queue;
+    size_t queueHead = 0;
+    std::vector<int> nodeOf;                  // клетка -> узел поиска
+    std::vector<int> stack;
+    std::vector<Connection> orScs;            // копия полусоединений пары для правила ИЛИ
+    ArenaVector<Connection> none{ArenaAllocator<Connection>(arena)};
+};
+
+enum SolveStatus { kSolveUnknown, kSolveWin, kSolveLoss };
+
+// Итог для стороны, которая ходит. При kSolveWin move — выигрывающая
+// клетка. mustPlay — клетки, вне которых любой ход проигрывает: у соперника
+// есть полусоединения сторон, и каждое надо разрушить.
+struct SolveResult {
+    SolveStatus status = kSolveUnknown;
+    int move = -1;
+    Bitboard mustPlay;
+};
+
+struct SolverLimits {
+    int timeMs = 100;
+    size_t memoryMb = 16;   // соединения одного поиска плюс кэш
+};
+
+struct SolverStats {
+    double seconds = 0.0;
+    size_t connections = 0;
+    long cacheHits = 0;
+    bool exhausted = false;  // бюджет кончился раньше вывода
+};
+
+// Решатель по виртуальным соединениям обоих игроков. Результаты хранятся
+// по хэшу позиции: повторный запрос той же позиции, например при
+// переборе, не повторяет поиск. Кэш — таблица прямого отображения на
+// половину memoryMb, выделяется при первом решении.
+class VcSolver {
+public:
+    explicit VcSolver(SolverLimits limits = SolverLimits());
+
+    SolveResult solve(const HexGame& game);
+    void setLimits(const SolverLimits& l) {
+        if (l.memoryMb != limits.memoryMb) cache.clear();   // пересоздаётся под новый размер
+        limits = l;
+    }
+    const SolverLimits& solverLimits() const { return limits; }
+    void clearCache();
+    const SolverStats& lastStats() const { return stats; }
+
+private:
+    HSearch::Budget budgetUntil(std::chrono::steady_clock::time_point deadline) const;
+    int pickWinningMove(const HexGame& game, const HSearch& found) const;
+
+    struct CacheSlot {
+        uint64_t key = 0;   // 0 — пустой слот
+        SolveResult result;
+    };
+
+    SolverLimits limits;
+    HSearch search;
+    std::vector<CacheSlot> cache;
+    SolverStats stats;
+};
+
+#endif // HEXCORE_HSEARCH_H
@@ -0,0 +1,146 @@
+#include "inferior.h"
+
+#include "patterns.h"
+
+namespace {
+
+// Состояние соседа с точки зрения одного игрока, как в кодах patterns.h;
+// мёртвые клетки закрыты для обоих.
+enum NeighborState { kFree = 0, kOwn = 1, kBlocked = 2 };
+
+constexpr int kMaxFillRounds = 4;
+
+// Доска с заполнением: захваченные клетки — камни захватившего, мёртвые
+// закрыты для обоих. Коды шаблонов свободных клеток хранятся и
+// пересчитываются только у соседей заполненной клетки.
+class FillIn {
+public:
+    FillIn(const HexGame& game, const Bitboard& free)
+        : geo(game.geometry()), ring(patternGeometry(game.getSize())), useless(patternTables().useless) {
+        stones[0] = game.stonesOf('X');
+        stones[1] = game.stonesOf('O');
+        free.forEach([&](int cell) { refresh(cell); });
+    }
+
+    bool isDead(int cell) const { return useless[codes[0][cell]] && useless[codes[1][cell]]; }
+
+    // Мёртвая ли клетка, если в соседней extra стоит камень цвета extraColor.
+    bool isDeadWith(int cell, int extra, int extraColor) const {
+        for (int d = 0; d < 6; ++d) {
+            if (geo.neighbors[cell][d] != extra) continue;
+            const int weight = kPatternDigits[d];
+            const int x = codes[0][cell] + ((extraColor == 0 ? kOwn : kBlocked) - kFree) * weight;
+            const int o = codes[1][cell] + ((extraColor == 1 ? kOwn : kBlocked) - kFree) * weight;
+            return useless[x] && useless[o];
+        }
+        return false;
+    }
+
+    void markDead(int cell) {
+        dead.set(cell);
+        refreshAround(cell);
+    }
+    void markStone(int cell, int color) {
+        stones[color].set(cell);
+        refreshAround(cell);
+    }
+
+    Bitboard stones[2];
+    Bitboard dead;
+    const BoardGeometry& geo;
+
+private:
+    void refreshAround(int cell) {
+        for (int nb : geo.neighbors[cell]) {
+            if (nb >= 0 && !stones[0].test(nb) && !stones[1].test(nb) && !dead.test(nb)) refresh(nb);
+        }
+    }
+
+    void refresh(int cell) {
+        const int cells = geo.cells;
+        for (int color = 0; color < 2; ++color) {
+            int code = 0;
+            for (int d = 0; d < 6; ++d) {
+                const int nb = ring.ring[cell][d];
+                int state;
+                if (nb >= cells) {
+                    state = nb == cells + 2 ? kFree : nb - cells == color ? kOwn : kBlocked;
+                } else if (stones[color].test(nb)) {
+                    state = kOwn;
+                } else if (stones[1 - color].test(nb) || dead.test(nb)) {
+                    state = kBlocked;
+                } else {
+                    state = kFree;
+                }
+                code += state * kPatternDigits[d];
+            }
+            codes[color][cell] = static_cast<int16_t>(code);
+        }
+    }
+
+    const PatternGeometry& ring;
+    const bool* useless;
+    int16_t codes[2][kMaxCells];
+};
+
+} // namespace
+
+InferiorCells findInferiorCells(const HexGame& game) {
+    InferiorCells result;
+    Bitboard free = game.emptyCells();
+    FillIn fill(game, free);
+    const BoardGeometry& geo = fill.geo;
+
+    for (int round = 0; round < kMaxFillRounds; ++round) {
+        bool changed = false;
+        const Bitboard candidates = free;
+        candidates.forEach([&](int cell) {
+            if (fill.isDead(cell)) {
+                fill.markDead(cell);
+                free.reset(cell);
+                changed = true;
+            }
+        });
+
+        // Пара соседних клеток захвачена, если камень игрока в любой из
+        // них делает другую мёртвой: на вторжение соперника он отвечает
+        // в пару. Пары не пересекаются, иначе ответ нужен в двух местах.
+        const Bitboard remaining = free;
+        remaining.forEach([&](int a) {
+            if (!free.test(a)) return;
+            for (int b : geo.neighbors[a]) {
+                if (b < 0 || !free.test(b)) continue;
+                for (int color = 0; color < 2; ++color) {
+                    if (!fill.isDeadWith(a, b, color) || !fill.isDeadWith(b, a, color)) continue;
+                    fill.markStone(a, color);
+                    fill.markStone(b, color);
+                    result.captured[color].set(a);
+                    result.captured[color].set(b);
+                    free.reset(a);
+                    free.reset(b);
+                    changed = true;
+                    return;
+                }
+            }
+        });
+        if (!changed) break;
+    }
+    result.dead = fill.dead;
+
+    // Подчинённую клетку отбрасываем, только пока её заменитель остаётся
+    // среди ходов: так из любой цепочки подчинения остаётся хотя бы один.
+    for (int color = 0; color < 2; ++color) {
+        Bitboard& pruned = result.dominated[color];
+        free.forEach([&](int cell) {
+            for (int k : geo.neighbors[cell]) {
+                if (k >= 0 && free.test(k) && !pruned.test(k) && fill.isDeadWith(cell, k, color)) {
+                    pruned.set(cell);
+                    return;
+                }
+            }
+        });
+        // Всё заполнено — исход решён, годится любой ход.
+        result.moves[color] = free.any() ? free.andNot(pruned) : game.emptyCells();
+    }
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef HEXCORE_INFERIOR_H
+#define HEXCORE_INFERIOR_H
+
+#include "hexgame.h"
+
+// Заведомо худшие ходы по локальным шаблонам вокруг клетки (соседи и
+// стороны доски, 3^6 вариантов на игрока):
+//  - мёртвая клетка не нужна ни одной цепи ни одного игрока — ход туда
+//    равен пропуску;
+//  - захваченная пара: ответ в пару делает чужой камень в ней мёртвым,
+//    поэтому пара уже принадлежит игроку;
+//  - подчинённая клетка: свой камень в соседней клетке делает её мёртвой,
+//    значит, ход в соседнюю не хуже.
+// Мёртвые и захваченные клетки заполняются, и поиск повторяется, пока
+// находятся новые.
+struct InferiorCells {
+    Bitboard dead;
+    Bitboard captured[2];   // индекс — colorIndex игрока, захватившего пару
+    Bitboard dominated[2];
+    Bitboard moves[2];      // оставшиеся ходы игрока; пусты только на полной доске
+
+    const Bitboard& movesFor(char player) const { return moves[colorIndex(player)]; }
+};
+
+InferiorCells findInferiorCells(const HexGame& game);
+
+#endif // HEXCORE_INFERIOR_H
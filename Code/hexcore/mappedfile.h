@@ -0,0 +1,33 @@
+#ifndef HEXCORE_MAPPEDFILE_H
+#define HEXCORE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Файл, целиком отображённый в память. Отображение для записи общее:
+// изменения попадают в файл и сразу видны другим процессам, открывшим его.
+// Страницы подгружает и вытесняет система, поэтому файл может быть больше
+// памяти машины.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, bool writable = false);
+    void close();
+    bool isOpen() const { return view != nullptr; }
+    void* data() const { return view; }
+    size_t size() const { return bytes; }
+
+private:
+    void* view = nullptr;
+    size_t bytes = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
+
+#endif // HEXCORE_MAPPEDFILE_H
@@ -0,0 +1,735 @@
+#include "mctsai.h"
+
+#include "inferior.h"
+#include "patterns.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+using std::pair;
+
+namespace {
+
+constexpr int32_t kUnexpanded = -1;
+constexpr int32_t kExpanding = -2;
+constexpr int32_t kExhausted = -3;   // пул закончился, узел остаётся листом
+constexpr uint32_t kExpandVisits = 2;  // лист раскрывается при повторном посещении
+constexpr int kPlayoutRejections = 1;  // после стольких отказов весов ход берётся как есть
+constexpr long kMinRatePlayouts = 256; // раньше скорость симуляций не оценить
+constexpr uint32_t kMaxDbVisits = 64;  // вес партий из базы позиций, не больше
+constexpr int kAnalysisIntervalMs = 100;
+
+template <typename Node>
+void copyNode(Node& dst, const Node& src) {
+    dst.firstChild.store(src.firstChild.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dst.childCount = src.childCount;
+    dst.move = src.move;
+    dst.visits.store(src.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dst.wins.store(src.wins.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Прибавление к счётчику: атомарное в общем дереве, обычное чтение-запись
+// в собственном дереве потока.
+inline uint32_t bump(std::atomic<uint32_t>& counter, bool shared) {
+    if (shared) return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint32_t v = counter.load(std::memory_order_relaxed) + 1;
+    counter.store(v, std::memory_order_relaxed);
+    return v;
+}
+
+} // namespace
+
+char winnerOnFullBoard(const BoardGeometry& geo, const Bitboard& xStones) {
+    Bitboard visited = xStones & geo.edge[kEdgeLeft];
+    const Bitboard& goal = geo.edge[kEdgeRight];
+    int stack[kMaxCells];
+    int top = 0;
+    visited.forEach([&](int idx) { stack[top++] = idx; });
+    while (top > 0) {
+        int idx = stack[--top];
+        if (goal.test(idx)) return 'X';
+        for (int nb : geo.neighbors[idx]) {
+            if (nb >= 0 && xStones.test(nb) && !visited.test(nb)) {
+                visited.set(nb);
+                stack[top++] = nb;
+            }
+        }
+    }
+    return 'O';
+}
+
+char patternPlayout(const HexGame& game, char toMove, uint64_t& rngState) {
+    const BoardGeometry& geo = game.geometry();
+    const PatternGeometry& pg = patternGeometry(game.getSize());
+    const PatternTables& pt = patternTables();
+    const int cells = geo.cells;
+    const Bitboard& xInitial = game.stonesOf('X');
+
+    // Коды окрестностей с точки зрения X ведутся инкрементально от кодов
+    // пустой доски; узлы за доской тоже получают записи, но не читаются
+    // (обнуляются, чтобы += не трогал неинициализированную память).
+    int16_t codes[kMaxCells + 3];
+    std::copy(pg.edgeCode, pg.edgeCode + cells, codes);
+    std::fill(codes + cells, codes + cells + 3, int16_t(0));
+    xInitial.forEach([&](int idx) { addStoneToCodes(pg, codes, idx, 0); });
+    game.stonesOf('O').forEach([&](int idx) { addStoneToCodes(pg, codes, idx, 1); });
+    int16_t empties[kMaxCells];
+    int16_t slot[kMaxCells];   // позиция клетки в empties
+    int k = 0;
+    game.emptyCells().forEach([&](int idx) {
+        slot[idx] = static_cast<int16_t>(k);
+        empties[k++] = static_cast<int16_t>(idx);
+    });
+    int last = game.lastMove();
+
+    Bitboard xStones = xInitial;
+    int color = colorIndex(toMove);
+    for (int i = 0; i < k; ++i) {
+        int cell = -1;
+        if (last >= 0) {
+            const int d = pt.bridgeReply[color][codes[last]];
+            if (d >= 0 && pg.ring[last][d] < cells) cell = pg.ring[last][d];
+        }
+        if (cell < 0) {
+            for (int tries = 0;; ++tries) {
+                const uint64_t r = splitMix64(rngState);
+                const uint32_t span = static_cast<uint32_t>(k - i);
+                cell = empties[i + static_cast<int>((static_cast<uint64_t>(static_cast<uint32_t>(r)) * span) >> 32)];
+                if (tries == kPlayoutRejections) break;
+                if (static_cast<int>((r >> 32) & kPatternWeightMax) < pt.weight[color][codes[cell]]) break;
+            }
+        }
+        const int j = slot[cell];
+        std::swap(empties[i], empties[j]);
+        slot[empties[j]] = static_cast<int16_t>(j);
+        slot[cell] = static_cast<int16_t>(i);
+        addStoneToCodes(pg, codes, cell, color);
+        if (color == 0) xStones.set(cell);
+        last = cell;
+        color ^= 1;
+    }
+    return winnerOnFullBoard(geo, xStones);
+}
+
+MctsAI::MctsAI(char aiChar, MctsLimits limits)
+    : playerChar(aiChar), limits(limits) {
+    std::random_device rd;
+    rngState = (uint64_t(rd()) << 32) ^ rd();
+}
+
+void MctsAI::prepareTrees(int count, int capacity, bool shared) {
+    if (static_cast<int>(trees.size()) != count) trees.resize(count);
+    for (auto& tree : trees) {
+        if (!tree) tree = std::make_unique<Tree>();
+        if (tree->capacity != capacity) {
+            tree->pool = std::make_unique<Node[]>(capacity);
+            tree->spare.reset();
+            tree->capacity = capacity;
+            tree->rootMoves = -1;
+            tree->trail.clear();
+        }
+        tree->shared = shared;
+    }
+}
+
+void MctsAI::clearTree() {
+    for (auto& tree : trees) {
+        tree->rootMoves = -1;
+        tree->trail.clear();
+    }
+}
+
+void MctsAI::resetRoot(Tree& tree, const HexGame& game, char toMove) {
+    Node& root = tree.pool[0];
+    root.firstChild.store(kUnexpanded, std::memory_order_relaxed);
+    root.childCount = 0;
+    root.move = -1;
+    root.visits.store(0, std::memory_order_relaxed);
+    root.wins.store(0, std::memory_order_relaxed);
+    tree.used.store(1, std::memory_order_relaxed);
+    tree.root = 0;
+    tree.rootMoves = game.moveCount();
+    tree.rootSize = game.getSize();
+    tree.rootToMove = toMove;
+    tree.rootStones[0] = game.stonesOf('X');
+    tree.rootStones[1] = game.stonesOf('O');
+    tree.rootHash = game.hash();
+    tree.trail.clear();
+}
+
+bool MctsAI::rerootTree(Tree& tree, const HexGame& game, char toMove) {
+    const int moves = game.moveCount();
+    if (tree.rootMoves < 0 || tree.rootMoves > moves || tree.rootSize != game.getSize()) return false;
+    if (tree.rootStones[0].andNot(game.stonesOf('X')).any() ||
+        tree.rootStones[1].andNot(game.stonesOf('O')).any())
+        return false;
+
+    // Ходы после корня должны идти по очереди и найтись в дереве.
+    // Пройденные узлы запоминаются для rewindTree.
+    const int N = game.getSize();
+    const size_t trailSize = tree.trail.size();
+    int node = tree.root;
+    char mover = tree.rootToMove;
+    uint64_t hash = tree.rootHash;
+    for (int k = tree.rootMoves; k < moves; ++k) {
+        const int cell = game.moveAt(k);
+        const Node& n = tree.pool[node];
+        const int first = n.firstChild.load(std::memory_order_relaxed);
+        int next = -1;
+        if (game.getCell(cell / N, cell % N) == mover && !tree.rootStones[0].test(cell) &&
+            !tree.rootStones[1].test(cell) && first >= 0) {
+            for (int i = 0; i < n.childCount; ++i) {
+                if (tree.pool[first + i].move == cell) {
+                    next = first + i;
+                    break;
+                }
+            }
+        }
+        if (next < 0) {
+            tree.trail.resize(trailSize);
+            return false;
+        }
+        tree.trail.push_back({node, k, hash, mover});
+        hash ^= kZobrist.stone[colorIndex(mover)][cell];
+        node = next;
+        mover = opponentOf(mover);
+    }
+    if (mover != toMove) {
+        tree.trail.resize(trailSize);
+        return false;
+    }
+
+    tree.root = node;
+    tree.rootMoves = moves;
+    tree.rootToMove = toMove;
+    tree.rootStones[0] = game.stonesOf('X');
+    tree.rootStones[1] = game.stonesOf('O');
+    tree.rootHash = game.hash();
+    return true;
+}
+
+// Отмена ходов: корень возвращается к последнему пройденному узлу, позиция
+// которого совпадает с началом партии game. Позиции сверяются по хэшу
+// первых ходов; дальше корень ведёт rerootTree.
+bool MctsAI::rewindTree(Tree& tree, const HexGame& game) {
+    if (tree.trail.empty() || tree.rootSize != game.getSize()) return false;
+    const int N = game.getSize();
+    const int moves = game.moveCount();
+    uint64_t prefix[kMaxCells + 1];
+    prefix[0] = 0;
+    for (int k = 0; k < moves; ++k) {
+        const int cell = game.moveAt(k);
+        prefix[k + 1] = prefix[k] ^ kZobrist.stone[colorIndex(game.getCell(cell / N, cell % N))][cell];
+    }
+    for (size_t i = tree.trail.size(); i-- > 0;) {
+        const RootMark mark = tree.trail[i];
+        if (mark.moves > moves || prefix[mark.moves] != mark.hash) continue;
+        tree.root = mark.node;
+        tree.rootMoves = mark.moves;
+        tree.rootToMove = mark.toMove;
+        tree.rootHash = mark.hash;
+        tree.rootStones[0].clear();
+        tree.rootStones[1].clear();
+        for (int k = 0; k < mark.moves; ++k) {
+            const int cell = game.moveAt(k);
+            tree.rootStones[colorIndex(game.getCell(cell / N, cell % N))].set(cell);
+        }
+        tree.trail.resize(i);
+        return true;
+    }
+    return false;
+}
+
+// Поддерево корня переносится в начало второго пула, и пулы меняются
+// местами: узлы ветвей, которые не случились в партии, освобождаются разом.
+// Перенос идёт в ширину, поэтому дети каждого узла по-прежнему лежат подряд:
+// уже перенесённые узлы служат очередью, и firstChild узла указывает в
+// старый пул, пока до него не дойдёт очередь. Предки корня тоже
+// освобождаются, и отмена ходов после этого начинает дерево заново.
+void MctsAI::compactTree(Tree& tree) {
+    if (!tree.spare) tree.spare = std::make_unique<Node[]>(tree.capacity);
+    const Node* from = tree.pool.get();
+    Node* to = tree.spare.get();
+    const int before = std::min(tree.used.load(std::memory_order_relaxed), tree.capacity);
+    copyNode(to[0], from[tree.root]);
+    int used = 1;
+    for (int i = 0; i < used; ++i) {
+        Node& node = to[i];
+        const int first = node.firstChild.load(std::memory_order_relaxed);
+        if (first < 0) {
+            // Листья, которым не хватило пула, снова могут раскрыться.
+            if (first == kExhausted) node.firstChild.store(kUnexpanded, std::memory_order_relaxed);
+            continue;
+        }
+        for (int k = 0; k < node.childCount; ++k) copyNode(to[used + k], from[first + k]);
+        node.firstChild.store(used, std::memory_order_relaxed);
+        used += node.childCount;
+    }
+    std::swap(tree.pool, tree.spare);
+    tree.used.store(used, std::memory_order_relaxed);
+    tree.root = 0;
+    tree.trail.clear();
+    stats.freedNodes += before - used;
+}
+
+// Корень, раскрытый прошлым поиском, сужается до allowed на месте: дети
+// сдвигаются к началу с сохранением порядка, поэтому непосещённые
+// по-прежнему образуют хвост, а статистика ветвей не теряется.
+bool MctsAI::restrictRoot(Tree& tree, const Bitboard& allowed) {
+    Node& root = tree.pool[tree.root];
+    const int first = root.firstChild.load(std::memory_order_relaxed);
+    if (first < 0) return true;
+    int present = 0;
+    for (int k = 0; k < root.childCount; ++k) present += allowed.test(tree.pool[first + k].move);
+    if (present != allowed.count()) return false;   // корень раскрыт уже, чем нужно
+    int kept = 0;
+    for (int k = 0; k < root.childCount; ++k) {
+        Node& src = tree.pool[first + k];
+        if (!allowed.test(src.move)) continue;
+        if (kept != k) copyNode(tree.pool[first + kept], src);
+        ++kept;
+    }
+    root.childCount = static_cast<int16_t>(kept);
+    return true;
+}
+
+pair<int, int> MctsAI::chooseMove(HexGame& game) {
+    if (!search(game, playerChar, false)) return {-1, -1};
+    const int N = game.getSize();
+    if (solvedMove >= 0) {
+        if (stats.solved == kSolveWin) stats.winRate = 1.0;
+        return {solvedMove / N, solvedMove % N};
+    }
+
+    // Посещения детей корня суммируются по всем деревьям.
+    uint32_t visitsByCell[kMaxCells] = {};
+    uint32_t winsByCell[kMaxCells] = {};
+    for (auto& tree : trees) {
+        const Node& root = tree->pool[tree->root];
+        const int first = root.firstChild.load(std::memory_order_relaxed);
+        for (int k = 0; k < root.childCount; ++k) {
+            const Node& ch = tree->pool[first + k];
+            visitsByCell[ch.move] += ch.visits.load(std::memory_order_relaxed);
+            winsByCell[ch.move] += ch.wins.load(std::memory_order_relaxed);
+        }
+    }
+    int bestCell = -1;
+    for (int idx : cellOrder) {
+        if (!allowedRoot.test(idx)) continue;
+        if (bestCell < 0 || visitsByCell[idx] > visitsByCell[bestCell]) bestCell = idx;
+    }
+    if (bestCell < 0) return {-1, -1};
+    if (visitsByCell[bestCell] > 0) stats.winRate = static_cast<double>(winsByCell[bestCell]) / visitsByCell[bestCell];
+    return {bestCell / N, bestCell % N};
+}
+
+Move MctsAI::think(const Position& position, const SearchLimits& request) {
+    playerChar = sideToMove(position);
+    const MctsLimits saved = limits;
+    const std::atomic<bool>* savedStop = externalStop;
+    if (request.timeMs > 0) limits.timeMs = request.timeMs;
+    if (request.remainingMs > 0) limits.remainingMs = request.remainingMs;
+    if (request.playouts > 0) limits.maxPlayouts = request.playouts;
+    if (request.threads > 0) limits.threads = request.threads;
+    if (request.stop) externalStop = request.stop;
+    HexGame work = position;
+    auto move = chooseMove(work);
+    limits = saved;
+    externalStop = savedStop;
+    return {move.first, move.second};
+}
+
+void MctsAI::ponder(const HexGame& game) {
+    // Без внешнего флага размышление некому остановить.
+    if (!externalStop) return;
+    search(game, opponentOf(playerChar), true);
+}
+
+bool MctsAI::search(const HexGame& game, char toMove, bool pondering) {
+    using Clock = std::chrono::steady_clock;
+    SearchShared shared;
+    shared.start = Clock::now();
+    shared.timed = !pondering;
+    stats = MctsStats();
+
+    const int N = game.getSize();
+    if (game.isFull() || game.checkWin('X') || game.checkWin('O')) return false;
+
+    if (static_cast<int>(cellOrder.size()) != N * N) {
+        cellOrder.resize(N * N);
+        for (int i = 0; i < N * N; ++i) cellOrder[i] = static_cast<int16_t>(i);
+        auto centerDist = [N](int idx) {
+            return std::abs(2 * (idx / N) - (N - 1)) + std::abs(2 * (idx % N) - (N - 1));
+        };
+        std::stable_sort(cellOrder.begin(), cellOrder.end(),
+                         [&](int a, int b) { return centerDist(a) < centerDist(b); });
+        clearTree();
+    }
+
+    solvedMove = -1;
+    // Заведомо худшие ходы в корне не рассматриваются.
+    allowedRoot = findInferiorCells(game).movesFor(toMove);
+    const bool managed = !pondering && limits.manageTime;
+    if (managed) timing.start(game, limits.timeMs, limits.remainingMs, allowedRoot.count());
+    if (!pondering && limits.solverMs > 0 && sideToMove(game) == toMove) {
+        SolverLimits solverLimits = solver.solverLimits();
+        const int budgetMs = managed && timing.limited() ? timing.softMs() : limits.timeMs;
+        solverLimits.timeMs = budgetMs > 0 ? std::min(limits.solverMs, std::max(1, budgetMs / 4)) : limits.solverMs;
+        solver.setLimits(solverLimits);
+        const SolveResult solved = solver.solve(game);
+        stats.solved = solved.status;
+        if (solved.status == kSolveWin && solved.move >= 0) {
+            solvedMove = solved.move;
+            stats.seconds = std::chrono::duration<double>(Clock::now() - shared.start).count();
+            return true;
+        }
+        if (solved.mustPlay.any()) {
+            const Bitboard both = allowedRoot & solved.mustPlay;
+            allowedRoot = both.any() ? both : solved.mustPlay;
+        }
+    }
+    if (!pondering && allowedRoot.count() == 1) {
+        allowedRoot.forEach([&](int idx) { solvedMove = idx; });
+        stats.seconds = std::chrono::duration<double>(Clock::now() - shared.start).count();
+        return true;
+    }
+
+    const int threadCount = std::max(1, limits.threads);
+    const bool rootParallel = threadCount > 1 && limits.parallel == kParallelRoot;
+    const int treeCount = rootParallel ? threadCount : 1;
+    prepareTrees(treeCount, std::max(2, limits.nodeCapacity / treeCount), threadCount > 1 && !rootParallel);
+    for (auto& tree : trees) {
+        const bool reused = rerootTree(*tree, game, toMove) ||
+                            (rewindTree(*tree, game) && rerootTree(*tree, game, toMove));
+        if (!reused) {
+            resetRoot(*tree, game, toMove);
+        } else if (tree->used.load(std::memory_order_relaxed) > tree->capacity / 2) {
+            // Пока пул свободен больше чем наполовину, предки корня остаются
+            // в нём для отмены ходов; дальше место нужнее поиску.
+            compactTree(*tree);
+        }
+        if (!restrictRoot(*tree, allowedRoot)) resetRoot(*tree, game, toMove);
+        // Размышление занимает не больше половины пула: остальное — поиску
+        // после ответа соперника.
+        tree->expandLimit = pondering ? tree->capacity / 2 : tree->capacity;
+        Node& root = tree->pool[tree->root];
+        stats.reusedVisits += root.visits.load(std::memory_order_relaxed);
+        if (root.firstChild.load(std::memory_order_relaxed) < 0) {
+            if (!tryExpand(*tree, root, game, toMove, &allowedRoot)) return false;
+            seedRoot(*tree, game, toMove);
+        }
+    }
+
+    // Поиск идёт на копиях, живая доска не меняется.
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < threadCount; ++t) {
+        Tree& tree = *trees[rootParallel ? t : 0];
+        uint64_t seed = splitMix64(rngState);
+        helpers.emplace_back([this, &tree, &game, seed, &shared] { runWorker(tree, game, seed, shared, false); });
+    }
+    runWorker(*trees[0], game, splitMix64(rngState), shared, true);
+    for (auto& th : helpers) th.join();
+    if (analysis && !pondering) publishAnalysis(*trees[0], shared.playouts.load(), shared);
+
+    int nodes = 0;
+    for (auto& tree : trees) nodes += std::min(tree->used.load(std::memory_order_relaxed), tree->capacity);
+    stats.playouts = shared.playouts.load();
+    stats.nodes = nodes;
+    stats.threads = threadCount;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - shared.start).count();
+    return true;
+}
+
+void MctsAI::runWorker(Tree& tree, const HexGame& game, uint64_t seed, SearchShared& shared, bool leader) {
+    using Clock = std::chrono::steady_clock;
+    HexGame work = game;
+    const int N = work.getSize();
+    const bool atomicTree = tree.shared;
+    const char rootToMove = tree.rootToMove;
+    const char rootOpponent = opponentOf(rootToMove);
+    const uint32_t expandAfter = static_cast<uint32_t>(std::max(0, limits.priorVisits)) + kExpandVisits;
+    uint64_t rng = seed;
+    int path[kMaxCells + 1];
+    int16_t moves[kMaxCells];
+    long pending = 0;   // симуляции, ещё не добавленные в общий счётчик
+    const bool publishing = leader && analysis && shared.timed;
+    auto nextAnalysis = shared.start + std::chrono::milliseconds(kAnalysisIntervalMs);
+
+    for (long iter = 0;; ++iter) {
+        if ((iter & 63) == 0) {
+            long total = shared.playouts.fetch_add(pending, std::memory_order_relaxed) + pending;
+            pending = 0;
+            if (shared.stop.load(std::memory_order_relaxed)) break;
+            bool done = externalStop && externalStop->load(std::memory_order_relaxed);
+            if (!done && shared.timed && limits.maxPlayouts > 0) done = total >= limits.maxPlayouts;
+            if (!done && shared.timed && limits.manageTime) {
+                done = timing.hardExpired() || (leader && enoughSearched(tree, total));
+            } else if (!done && shared.timed && limits.timeMs > 0) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - shared.start);
+                done = elapsed.count() >= limits.timeMs;
+            }
+            if (done) {
+                shared.stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            if (publishing && Clock::now() >= nextAnalysis) {
+                publishAnalysis(tree, total, shared);
+                nextAnalysis = Clock::now() + std::chrono::milliseconds(kAnalysisIntervalMs);
+            }
+        }
+
+        int depth = 0;
+        int moveCount = 0;
+        int node = tree.root;
+        char toMove = rootToMove;
+        char winner = 0;
+        path[depth++] = node;
+
+        // Спуск по UCT. Посещение засчитывается сразу: пока симуляция не
+        // закончилась, оно работает как виртуальная потеря и уводит другие
+        // потоки в соседние ветви. Лист раскрывается при повторном посещении,
+        // априорные посещения не в счёт.
+        while (true) {
+            Node& n = tree.pool[node];
+            uint32_t visits = bump(n.visits, atomicTree);
+            if (n.firstChild.load(std::memory_order_acquire) < 0) {
+                if (visits < expandAfter || !tryExpand(tree, n, work, toMove)) break;
+            }
+            int child = selectChild(tree, n);
+            int cell = tree.pool[child].move;
+            work.makeMove(cell / N, cell % N, toMove);
+            moves[moveCount++] = static_cast<int16_t>(cell);
+            path[depth++] = child;
+            node = child;
+            if (work.checkWin(toMove)) {
+                winner = toMove;
+                bump(tree.pool[node].visits, atomicTree);
+                break;
+            }
+            toMove = opponentOf(toMove);
+        }
+
+        if (!winner) winner = playout(work, toMove, rng);
+
+        // В узле нечётной глубины стоит ход того, кто ходил в корне.
+        for (int d = 1; d < depth; ++d) {
+            char mover = (d & 1) ? rootToMove : rootOpponent;
+            if (mover == winner) bump(tree.pool[path[d]].wins, atomicTree);
+        }
+        while (moveCount > 0) {
+            int cell = moves[--moveCount];
+            work.undoMove(cell / N, cell % N);
+        }
+        ++pending;
+    }
+    shared.playouts.fetch_add(pending, std::memory_order_relaxed);
+}
+
+// Лучший по посещениям ход корня передаётся распорядителю времени. Кроме
+// его правил, поиск кончается, когда отрыв лучшего от второго больше
+// симуляций, которые успеют пройти до жёсткого срока: выбор уже не изменится.
+bool MctsAI::enoughSearched(const Tree& tree, long playouts) {
+    if (!timing.limited()) return false;
+    const Node& root = tree.pool[tree.root];
+    const int first = root.firstChild.load(std::memory_order_acquire);
+    if (first < 0) return false;
+    uint32_t best = 0, second = 0;
+    int bestMove = -1;
+    for (int k = 0; k < root.childCount; ++k) {
+        const Node& ch = tree.pool[first + k];
+        const uint32_t v = ch.visits.load(std::memory_order_relaxed);
+        if (v > best) {
+            second = best;
+            best = v;
+            bestMove = ch.move;
+        } else if (v > second) {
+            second = v;
+        }
+    }
+    timing.noteBest(bestMove);
+    if (timing.shouldStop()) return true;
+    // Отрыв может прийти из прошлого поиска, а скорость — только из этого.
+    const int elapsed = timing.elapsedMs();
+    if (elapsed <= 0 || playouts < kMinRatePlayouts) return false;
+    const double ahead = static_cast<double>(playouts) / elapsed * timing.remainingMs();
+    return best - second > ahead;
+}
+
+// Снимок читается из дерева, которое меняют другие потоки: счётчики могут
+// разойтись на несколько симуляций, а главный вариант обрывается на
+// узлах, ещё не раскрытых до конца.
+void MctsAI::publishAnalysis(const Tree& tree, long playouts, const SearchShared& shared) {
+    AnalysisSnapshot& snap = analysis->writeBuffer();
+    const int N = tree.rootSize;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.start).count();
+    snap.size = N;
+    snap.toMove = tree.rootToMove;
+    snap.hash = tree.rootHash;
+    snap.playouts = playouts;
+    snap.playoutsPerSecond = seconds > 0.0 ? playouts / seconds : 0.0;
+    std::fill(snap.visits, snap.visits + N * N, 0u);
+    std::fill(snap.winRate, snap.winRate + N * N, 0.0f);
+
+    const Node& root = tree.pool[tree.root];
+    snap.rootVisits = root.visits.load(std::memory_order_relaxed);
+    int first = root.firstChild.load(std::memory_order_acquire);
+    for (int k = 0; first >= 0 && k < root.childCount; ++k) {
+        const Node& ch = tree.pool[first + k];
+        const uint32_t visits = ch.visits.load(std::memory_order_relaxed);
+        snap.visits[ch.move] = visits;
+        if (visits > 0) snap.winRate[ch.move] = static_cast<float>(ch.wins.load(std::memory_order_relaxed)) / visits;
+    }
+
+    // Главный вариант — самые посещаемые дети, пока их посещения не
+    // сводятся к априорным.
+    const uint32_t minVisits = static_cast<uint32_t>(std::max(0, limits.priorVisits)) + kExpandVisits;
+    snap.pvLength = 0;
+    for (int node = tree.root; snap.pvLength < AnalysisSnapshot::kMaxPv;) {
+        const Node& n = tree.pool[node];
+        first = n.firstChild.load(std::memory_order_acquire);
+        if (first < 0) break;
+        int best = -1;
+        uint32_t bestVisits = minVisits;
+        for (int k = 0; k < n.childCount; ++k) {
+            const uint32_t visits = tree.pool[first + k].visits.load(std::memory_order_relaxed);
+            if (visits > bestVisits) {
+                bestVisits = visits;
+                best = first + k;
+            }
+        }
+        if (best < 0) break;
+        snap.pv[snap.pvLength++] = tree.pool[best].move;
+        node = best;
+    }
+    analysis->publish();
+}
+
+bool MctsAI::tryExpand(Tree& tree, Node& node, const HexGame& game, char toMove, const Bitboard* only) {
+    const Bitboard allowed = only ? *only : game.emptyCells();
+    const int empties = allowed.count();
+    // За мягкой границей узел остаётся нераскрытым до следующего поиска.
+    if (tree.expandLimit < tree.capacity &&
+        tree.used.load(std::memory_order_relaxed) + empties > tree.expandLimit)
+        return false;
+
+    int32_t expected = kUnexpanded;
+    if (!node.firstChild.compare_exchange_strong(expected, kExpanding, std::memory_order_acquire)) {
+        // Другой поток уже раскрывает узел или пул исчерпан — остаёмся в листе.
+        return expected >= 0;
+    }
+    const int first = empties > 0 ? tree.used.fetch_add(empties, std::memory_order_relaxed) : 0;
+    if (empties == 0 || first + empties > tree.capacity) {
+        node.firstChild.store(kExhausted, std::memory_order_release);
+        return false;
+    }
+
+    // Априорная доля побед от 0.3 до 0.7 по весу окрестности клетки.
+    const uint32_t prior = static_cast<uint32_t>(std::max(0, limits.priorVisits));
+    const PatternGeometry& pg = patternGeometry(game.getSize());
+    const PatternTables& pt = patternTables();
+    const Bitboard& xStones = game.stonesOf('X');
+    const Bitboard& oStones = game.stonesOf('O');
+    const int cells = game.getSize() * game.getSize();
+    const int color = colorIndex(toMove);
+    int slot = first;
+    for (int idx : cellOrder) {
+        if (!allowed.test(idx)) continue;
+        Node& ch = tree.pool[slot++];
+        ch.firstChild.store(kUnexpanded, std::memory_order_relaxed);
+        ch.childCount = 0;
+        ch.move = static_cast<int16_t>(idx);
+        uint32_t wins = 0;
+        if (prior > 0) {
+            const int code = neighborhoodCode(pg, xStones, oStones, cells, idx);
+            const double rate = 0.3 + 0.4 * pt.weight[color][code] / kPatternWeightMax;
+            wins = static_cast<uint32_t>(rate * prior + 0.5);
+        }
+        ch.visits.store(prior, std::memory_order_relaxed);
+        ch.wins.store(wins, std::memory_order_relaxed);
+    }
+    node.childCount = static_cast<int16_t>(empties);
+    node.firstChild.store(first, std::memory_order_release);
+    return true;
+}
+
+void MctsAI::seedRoot(Tree& tree, const HexGame& game, char toMove) {
+    // Без априорных посещений непосещённые дети должны оставаться хвостом.
+    if (!positions || !positions->isOpen() || limits.priorVisits <= 0 || sideToMove(game) != toMove) return;
+    const Node& root = tree.pool[tree.root];
+    const int first = root.firstChild.load(std::memory_order_relaxed);
+    if (first < 0) return;
+    const int N = game.getSize();
+    HexGame work = game;
+    for (int k = 0; k < root.childCount; ++k) {
+        Node& ch = tree.pool[first + k];
+        const int r = ch.move / N;
+        const int c = ch.move % N;
+        work.makeMove(r, c, toMove);
+        PositionStats found;
+        const bool known = positions->lookup(work, found);
+        work.undoMove(r, c);
+        if (!known || found.visits == 0) continue;
+        // В базе победы стороны, которая ходит после move, — соперника.
+        const uint32_t visits = std::min(found.visits, kMaxDbVisits);
+        const double rate = 1.0 - found.winRate();
+        ch.visits.fetch_add(visits, std::memory_order_relaxed);
+        ch.wins.fetch_add(static_cast<uint32_t>(rate * visits + 0.5), std::memory_order_relaxed);
+    }
+}
+
+int MctsAI::selectChild(const Tree& tree, const Node& node) const {
+    const int first = node.firstChild.load(std::memory_order_relaxed);
+    const Node* kids = &tree.pool[first];
+    const int count = node.childCount;
+    // Непосещённые дети всегда образуют хвост: они выбираются по порядку.
+    if (kids[count - 1].visits.load(std::memory_order_relaxed) == 0) {
+        int k = 0;
+        while (kids[k].visits.load(std::memory_order_relaxed) != 0) ++k;
+        return first + k;
+    }
+    const uint32_t parentVisits = node.visits.load(std::memory_order_relaxed);
+    const float scale = static_cast<float>(limits.exploration *
+                                           std::sqrt(std::log(static_cast<double>(parentVisits))));
+    int best = 0;
+    float bestScore = -1.0f;
+    for (int k = 0; k < count; ++k) {
+        float inv = 1.0f / static_cast<float>(kids[k].visits.load(std::memory_order_relaxed));
+        float score = static_cast<float>(kids[k].wins.load(std::memory_order_relaxed)) * inv + scale * std::sqrt(inv);
+        if (score > bestScore) {
+            bestScore = score;
+            best = k;
+        }
+    }
+    return first + best;
+}
+
+char MctsAI::playout(const HexGame& game, char toMove, uint64_t& rng) const {
+    if (limits.patternPlayouts) return patternPlayout(game, toMove, rng);
+    // На полной доске важно только, какие клетки достались X: ходящий
+    // получает ceil(k/2) из k пустых, поэтому достаточно частичного
+    // перемешивания Фишера–Йетса.
+    int16_t empties[kMaxCells];
+    int k = 0;
+    game.emptyCells().forEach([&](int idx) { empties[k++] = static_cast<int16_t>(idx); });
+    const int xCount = toMove == 'X' ? (k + 1) / 2 : k / 2;
+
+    Bitboard xStones = game.stonesOf('X');
+    for (int i = 0; i < xCount; ++i) {
+        uint32_t span = static_cast<uint32_t>(k - i);
+        int j = i + static_cast<int>((static_cast<uint64_t>(static_cast<uint32_t>(splitMix64(rng))) * span) >> 32);
+        std::swap(empties[i], empties[j]);
+        xStones.set(empties[i]);
+    }
+    return winnerOnFullBoard(game.geometry(), xStones);
+}
@@ -0,0 +1,170 @@
+#ifndef HEXCORE_MCTSAI_H
+#define HEXCORE_MCTSAI_H
+
+#include "analysis.h"
+#include "engine.h"
+#include "hexgame.h"
+#include "hsearch.h"
+#include "positiondb.h"
+#include "timemanager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Корневой параллелизм: у каждого потока своё дерево, посещения корня
+// складываются в конце. Общее дерево: потоки спускаются по одному дереву
+// с атомарными счётчиками и виртуальной потерей.
+enum MctsParallelMode { kParallelRoot, kParallelTree };
+
+struct MctsLimits {
+    int timeMs = 1000;            // 0 — без ограничения по времени
+    long maxPlayouts = 0;         // 0 — без ограничения по числу симуляций
+    double exploration = 1.0;     // константа UCT
+    int nodeCapacity = 1 << 21;   // размер пула узлов на весь поиск
+    int threads = 1;
+    MctsParallelMode parallel = kParallelTree;
+    int solverMs = 100;           // решатель перед поиском, не больше четверти мягкого срока; 0 — без него
+    bool patternPlayouts = true;  // симуляции по шаблонам (patternPlayout); false — равномерные
+    int priorVisits = 8;          // вес оценки шаблона у новых узлов в посещениях; 0 — без неё
+    int remainingMs = 0;          // остаток часов на партию; 0 — часов нет
+    bool manageTime = true;       // мягкий срок и ранняя остановка (timemanager.h); false — весь timeMs
+};
+
+struct MctsStats {
+    long playouts = 0;
+    long reusedVisits = 0;        // посещения корня, унаследованные от прошлого поиска
+    int freedNodes = 0;           // узлы несыгранных ветвей, освобождённые перед поиском
+    int nodes = 0;
+    int threads = 1;
+    double winRate = 0.0;         // доля побед ИИ в симуляциях через выбранный ход
+    SolveStatus solved = kSolveUnknown;
+    double seconds = 0.0;
+
+    double playoutsPerSecond() const { return seconds > 0.0 ? playouts / seconds : 0.0; }
+};
+
+// UCT: дерево в пуле узлов, симуляции до заполнения доски. Новые узлы
+// получают априорную оценку по окрестности клетки (patterns.h).
+// Перед поиском решатель по виртуальным соединениям: доказанная победа
+// играется сразу, а корень раскрывается только ходами, которые не
+// проигрывают сразу по полусоединению соперника и не попадают в мёртвые,
+// захваченные или подчинённые клетки. Единственный такой ход играется
+// без поиска; поиск кончается раньше timeMs, когда отрыв лучшего хода уже
+// не отыграть или он давно не меняется.
+class MctsAI : public Engine {
+public:
+    explicit MctsAI(char aiChar, MctsLimits limits = MctsLimits());
+
+    std::pair<int, int> chooseMove(HexGame& game);
+    // Играет за сторону, которая ходит в position. Дерево хранит, кто ходит
+    // в корне, поэтому смена цвета не мешает его переиспользовать.
+    Move think(const Position& position, const SearchLimits& limits) override;
+
+    // Размышление в ход соперника: дерево строится для позиции после хода ИИ,
+    // пока не поднят флаг остановки. Если соперник ответит ходом из дерева,
+    // следующий chooseMove продолжит с этой ветви.
+    void ponder(const HexGame& game);
+
+    // Флаг прерывает и поиск, и размышление; ход выбирается по собранной статистике.
+    void setStopFlag(const std::atomic<bool>* flag) { externalStop = flag; }
+    // Исходы сыгранных партий из базы позиций добавляются к априорной
+    // оценке ходов корня; nullptr — без базы.
+    void setPositions(const PositionDB* db) { positions = db; }
+    // Во время поиска ведущий поток раз в kAnalysisIntervalMs публикует
+    // снимок корня (при корневом параллелизме — своего дерева); nullptr —
+    // без снимков. Размышление снимков не публикует.
+    void setAnalysis(AnalysisBuffer* buffer) { analysis = buffer; }
+    void clearTree();
+
+    const MctsStats& lastStats() const { return stats; }
+    MctsLimits& searchLimits() { return limits; }
+
+private:
+    // Счётчики атомарны, чтобы узлы общего дерева можно было обновлять из
+    // нескольких потоков; в однопоточном дереве они пишутся без lock-префикса.
+    struct Node {
+        std::atomic<int32_t> firstChild;  // kUnexpanded, kExpanding или индекс первого ребёнка
+        int16_t childCount;
+        int16_t move;                     // клетка хода, ведущего в узел
+        std::atomic<uint32_t> visits;     // включая виртуальные потери идущих спусков
+        std::atomic<uint32_t> wins;       // победы игрока, сделавшего move
+    };
+
+    // Пройденный корень: узел остаётся в пуле, пока дерево не начато
+    // заново, и после отмены ходов поиск продолжается с него.
+    struct RootMark {
+        int node;
+        int moves;
+        uint64_t hash;                    // хэш позиции узла
+        char toMove;
+    };
+
+    struct Tree {
+        std::unique_ptr<Node[]> pool;
+        std::unique_ptr<Node[]> spare;    // второй пул для compactTree
+        int capacity = 0;
+        int expandLimit = 0;              // граница пула для новых раскрытий
+        std::atomic<int> used{0};
+        bool shared = false;
+        // Позиция в корне: по ней следующий поиск находит свою ветвь.
+        int root = 0;
+        int rootMoves = -1;               // -1 — дерево не соответствует позиции
+        int rootSize = 0;
+        char rootToMove = 'X';
+        Bitboard rootStones[2];
+        uint64_t rootHash = 0;
+        std::vector<RootMark> trail;      // прежние корни, от начала партии
+    };
+
+    struct SearchShared {
+        std::chrono::steady_clock::time_point start;
+        std::atomic<long> playouts{0};
+        std::atomic<bool> stop{false};
+        bool timed = true;                // при размышлении лимиты не действуют
+    };
+
+    bool search(const HexGame& game, char toMove, bool pondering);
+    void prepareTrees(int count, int capacity, bool shared);
+    void resetRoot(Tree& tree, const HexGame& game, char toMove);
+    bool rerootTree(Tree& tree, const HexGame& game, char toMove);
+    bool rewindTree(Tree& tree, const HexGame& game);
+    void compactTree(Tree& tree);
+    bool restrictRoot(Tree& tree, const Bitboard& allowed);
+    // Решения о ранней остановке принимает один поток, ведущий.
+    void runWorker(Tree& tree, const HexGame& game, uint64_t seed, SearchShared& shared, bool leader);
+    bool enoughSearched(const Tree& tree, long playouts);
+    void publishAnalysis(const Tree& tree, long playouts, const SearchShared& shared);
+    bool tryExpand(Tree& tree, Node& node, const HexGame& game, char toMove, const Bitboard* only = nullptr);
+    void seedRoot(Tree& tree, const HexGame& game, char toMove);
+    int selectChild(const Tree& tree, const Node& node) const;
+    char playout(const HexGame& game, char toMove, uint64_t& rng) const;
+
+    char playerChar;
+    MctsLimits limits;
+    MctsStats stats;
+    std::vector<std::unique_ptr<Tree>> trees;
+    std::vector<int16_t> cellOrder;   // клетки от центра к краям
+    VcSolver solver;
+    int solvedMove = -1;              // ход без поиска: доказанный выигрыш или единственный допустимый
+    Bitboard allowedRoot;             // допустимые ходы корня после решателя
+    TimeManager timing;
+    uint64_t rngState;
+    const std::atomic<bool>* externalStop = nullptr;
+    const PositionDB* positions = nullptr;
+    AnalysisBuffer* analysis = nullptr;
+};
+
+// Определяет победителя на полностью заполненной доске: ничьих в Гексе нет,
+// поэтому достаточно проверить, соединил ли X свои стороны.
+char winnerOnFullBoard(const BoardGeometry& geo, const Bitboard& xStones);
+
+// Симуляция по шаблонам до заполнения доски, возвращает победителя. На
+// вторжение в мост сразу следует ответ во вторую клетку моста, остальные
+// ходы случайны с весами окрестности клетки.
+char patternPlayout(const HexGame& game, char toMove, uint64_t& rngState);
+
+#endif // HEXCORE_MCTSAI_H
@@ -0,0 +1,107 @@
+#include "openingbook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+// Заголовок файла; числа записываются в порядке байт машины (little-endian
+// на всех поддерживаемых платформах).
+struct BookHeader {
+    char magic[8];
+    uint32_t count;
+    uint32_t entrySize;
+};
+
+constexpr char kBookMagic[8] = {'H', 'E', 'X', 'B', 'O', 'O', 'K', '1'};
+
+static_assert(sizeof(BookEntry) == 16, "формат файла книги");
+static_assert(sizeof(BookHeader) == 16, "формат файла книги");
+
+// Номера для перемешивания вне диапазона ключей камней.
+constexpr uint64_t kSizeSalt = 0x10000;
+constexpr uint64_t kSwapSalt = 0x20000;
+
+} // namespace
+
+uint64_t bookKey(const HexGame& game) {
+    uint64_t key = game.canonicalHash() ^ mixKey(kSizeSalt + game.getSize());
+    if (game.canSwap()) key ^= mixKey(kSwapSalt);
+    return key;
+}
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(BookHeader)) {
+        close();
+        return false;
+    }
+
+    const auto* header = static_cast<const BookHeader*>(file.data());
+    const size_t available = (file.size() - sizeof(BookHeader)) / sizeof(BookEntry);
+    if (std::memcmp(header->magic, kBookMagic, sizeof(kBookMagic)) != 0 ||
+        header->entrySize != sizeof(BookEntry) || header->count > available) {
+        close();
+        return false;
+    }
+    entries = reinterpret_cast<const BookEntry*>(static_cast<const char*>(file.data()) + sizeof(BookHeader));
+    count = header->count;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    entries = nullptr;
+    count = 0;
+}
+
+Move OpeningBook::lookup(const HexGame& game) const {
+    if (!entries) return Move();
+    const uint64_t key = bookKey(game);
+    const BookEntry* end = entries + count;
+    const BookEntry* it = std::lower_bound(entries, end, key,
+                                           [](const BookEntry& e, uint64_t k) { return e.key < k; });
+    if (it == end || it->key != key) return Move();
+    if (it->move == kBookSwap) return game.canSwap() ? Move::swapMove() : Move();
+
+    const int N = game.getSize();
+    int cell = it->move;
+    if (cell < 0 || cell >= N * N) return Move();
+    if (game.canonicalRotated()) cell = N * N - 1 - cell;
+    // Совпадение 64-битных ключей разных позиций маловероятно, но занятую
+    // клетку всё равно не возвращаем.
+    if (!game.isCellEmpty(cell / N, cell % N)) return Move();
+    return {cell / N, cell % N};
+}
+
+bool OpeningBook::write(const std::string& path, std::vector<BookEntry> entries) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const BookEntry& a, const BookEntry& b) { return a.key == b.key; }),
+                  entries.end());
+
+    BookHeader header;
+    std::memcpy(header.magic, kBookMagic, sizeof(kBookMagic));
+    header.count = static_cast<uint32_t>(entries.size());
+    header.entrySize = sizeof(BookEntry);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(BookEntry)));
+    return static_cast<bool>(out);
+}
+
+BookEngine::BookEngine(std::unique_ptr<Engine> inner, std::shared_ptr<const OpeningBook> book)
+    : inner(std::move(inner)), book(std::move(book)) {
+}
+
+Move BookEngine::think(const Position& position, const SearchLimits& limits) {
+    if (book) {
+        Move move = book->lookup(position);
+        if (move.isValid()) return move;
+    }
+    return inner->think(position, limits);
+}
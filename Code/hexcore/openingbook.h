@@ -0,0 +1,64 @@
+#ifndef HEXCORE_OPENINGBOOK_H
+#define HEXCORE_OPENINGBOOK_H
+
+#include "engine.h"
+#include "hexgame.h"
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Запись книги: ход в канонической форме позиции. Клетка — индекс на
+// доске канонической формы или kBookSwap.
+struct BookEntry {
+    uint64_t key;
+    int16_t move;
+    int16_t score;          // доля побед стороны, которая ходит, в тысячных
+    uint32_t visits;        // симуляций при построении
+};
+
+constexpr int16_t kBookSwap = -2;
+
+// Ключ книги: канонический хэш с поправкой на размер доски и на право
+// обмена, чтобы одна книга обслуживала несколько размеров.
+uint64_t bookKey(const HexGame& game);
+
+// Дебютная книга в двоичном файле: заголовок и отсортированные по ключу
+// записи по 16 байт. Файл отображается в память целиком, поиск — бинарный,
+// поэтому ход из книги находится за микросекунды без загрузки.
+class OpeningBook {
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+    const BookEntry* data() const { return entries; }
+
+    // Ход за сторону, которая ходит в game, или невалидный Move, если
+    // позиции нет в книге.
+    Move lookup(const HexGame& game) const;
+
+    // Записи сортируются по ключу; при повторе ключа остаётся первая.
+    static bool write(const std::string& path, std::vector<BookEntry> entries);
+
+private:
+    const BookEntry* entries = nullptr;
+    size_t count = 0;
+    MappedFile file;
+};
+
+// Сначала книга, затем поиск вложенного движка.
+class BookEngine : public Engine {
+public:
+    BookEngine(std::unique_ptr<Engine> inner, std::shared_ptr<const OpeningBook> book);
+    Move think(const Position& position, const SearchLimits& limits) override;
+
+private:
+    std::unique_ptr<Engine> inner;
+    std::shared_ptr<const OpeningBook> book;
+};
+
+#endif // HEXCORE_OPENINGBOOK_H
@@ -0,0 +1,136 @@
+#include "patterns.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// Тот же порядок соседей по кругу, что в hexgame.cpp.
+const int kHexDirections[6][2] = {
+    {-1, 0}, {-1, 1}, {0, 1},
+    {1, 0}, {1, -1}, {0, -1}
+};
+
+enum NeighborState { kFree = 0, kOwn = 1, kOpponent = 2 };
+
+void buildPatternGeometry(PatternGeometry& pg, int size) {
+    const int cells = size * size;
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            for (int d = 0; d < 6; ++d) {
+                const int nr = r + kHexDirections[d][0];
+                const int nc = c + kHexDirections[d][1];
+                const bool rowOut = nr < 0 || nr >= size;
+                const bool colOut = nc < 0 || nc >= size;
+                int nb = nr * size + nc;
+                // X владеет левой и правой сторонами, O — верхней и нижней.
+                if (rowOut && colOut) nb = cells + 2;
+                else if (colOut) nb = cells;
+                else if (rowOut) nb = cells + 1;
+                pg.ring[r * size + c][d] = static_cast<int16_t>(nb);
+            }
+        }
+    }
+    for (int cell = 0; cell < cells; ++cell) {
+        int code = 0;
+        for (int d = 0; d < 6; ++d) {
+            const int nb = pg.ring[cell][d];
+            if (nb >= cells && nb < cells + 2) code += (nb - cells + 1) * kPatternDigits[d];
+        }
+        pg.edgeCode[cell] = static_cast<int16_t>(code);
+    }
+}
+
+void decode(int code, int s[6]) {
+    for (int d = 0; d < 6; ++d) {
+        s[d] = code % 3;
+        code /= 3;
+    }
+}
+
+// Цепь через клетку входит и выходит через двух доступных соседей. Если
+// любые два доступных соседа связаны мимо клетки — смежны или разделены
+// по кругу только своими камнями, — клетку всегда можно обойти.
+bool uselessPattern(const int s[6]) {
+    for (int i = 0; i < 6; ++i) {
+        if (s[i] == kOpponent) continue;
+        for (int j = i + 1; j < 6; ++j) {
+            if (s[j] == kOpponent) continue;
+            bool forward = true;
+            for (int k = i + 1; k < j; ++k) forward = forward && s[k] == kOwn;
+            bool backward = true;
+            for (int k = j + 1; k < i + 6; ++k) backward = backward && s[k % 6] == kOwn;
+            if (!forward && !backward) return false;
+        }
+    }
+    return true;
+}
+
+// Число непрерывных дуг из соседей цвета v.
+int runsOf(const int s[6], int v) {
+    int runs = 0;
+    for (int d = 0; d < 6; ++d) {
+        if (s[d] == v && s[(d + 5) % 6] != v) ++runs;
+    }
+    return runs == 0 && s[0] == v ? 1 : runs;
+}
+
+// Ход, соединяющий две свои дуги или разрезающий две чужие, важнее
+// прочих; клетка, которую можно обойти обоим, почти не нужна.
+int weightPattern(const int s[6], bool dead) {
+    if (dead) return 4;
+    const int own = runsOf(s, kOwn);
+    const int opponent = runsOf(s, kOpponent);
+    int w = 48;
+    if (own >= 2) w += 96;
+    if (opponent >= 2) w += 96;
+    if (own > 0 && opponent > 0) w += 32;
+    return std::min(w, kPatternWeightMax);
+}
+
+PatternTables* buildTables() {
+    auto* t = new PatternTables();
+    for (int code = 0; code < kNeighborhoodCodes; ++code) {
+        int s[6];
+        decode(code, s);
+        t->useless[code] = uselessPattern(s);
+    }
+    for (int code = 0; code < kNeighborhoodCodes; ++code) {
+        int s[6];
+        decode(code, s);
+        int flipped = 0;
+        for (int d = 5; d >= 0; --d) flipped = flipped * 3 + (s[d] == kFree ? kFree : 3 - s[d]);
+        const bool dead = t->useless[code] && t->useless[flipped];
+        for (int color = 0; color < 2; ++color) {
+            int own[6];
+            for (int d = 0; d < 6; ++d) own[d] = color == 0 || s[d] == kFree ? s[d] : 3 - s[d];
+            t->weight[color][code] = static_cast<uint8_t>(weightPattern(own, dead));
+            // Мост: два своих соседа через одного, оба касаются и клетки
+            // вторжения, и пустого общего соседа между ними.
+            t->bridgeReply[color][code] = -1;
+            for (int d = 0; d < 6; ++d) {
+                if (own[d] == kOwn && own[(d + 2) % 6] == kOwn && own[(d + 1) % 6] == kFree) {
+                    t->bridgeReply[color][code] = static_cast<int8_t>((d + 1) % 6);
+                    break;
+                }
+            }
+        }
+    }
+    return t;
+}
+
+} // namespace
+
+const PatternGeometry& patternGeometry(int size) {
+    static const auto table = [] {
+        auto* t = new std::array<PatternGeometry, kMaxBoardSize + 1>();
+        for (int n = 1; n <= kMaxBoardSize; ++n) buildPatternGeometry((*t)[n], n);
+        return t;
+    }();
+    return (*table)[std::clamp(size, 1, kMaxBoardSize)];
+}
+
+const PatternTables& patternTables() {
+    static const PatternTables* tables = buildTables();
+    return *tables;
+}
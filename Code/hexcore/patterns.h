@@ -0,0 +1,57 @@
+#ifndef HEXCORE_PATTERNS_H
+#define HEXCORE_PATTERNS_H
+
+#include "hexgame.h"
+
+#include <cstdint>
+
+// Окрестность клетки — шесть соседей по кругу в порядке BoardGeometry.
+// Код по основанию 3 записывается с точки зрения игрока: 0 — пусто,
+// 1 — свой камень, 2 — чужой. Сторона доски — камень её хозяина; угловой
+// сосед за доской принадлежит обеим сторонам и считается пустым.
+constexpr int kNeighborhoodCodes = 729;   // 3^6
+constexpr int kPatternWeightMax = 255;
+
+// Соседи по кругу, где за доской стоят особые узлы: cells — сторона X,
+// cells + 1 — сторона O, cells + 2 — угол.
+struct PatternGeometry {
+    int16_t ring[kMaxCells][6];
+    int16_t edgeCode[kMaxCells];   // код с точки зрения X на пустой доске
+};
+
+const PatternGeometry& patternGeometry(int size);
+
+// bridgeReply и weight индексируются colorIndex игрока и кодом с точки
+// зрения X, чтобы симуляции хватало одного набора кодов на обоих.
+struct PatternTables {
+    int8_t bridgeReply[2][kNeighborhoodCodes];  // сосед, спасающий мост после чужого хода в клетку, или -1
+    uint8_t weight[2][kNeighborhoodCodes];      // вес хода игрока в клетку, 4..kPatternWeightMax
+    bool useless[kNeighborhoodCodes];           // клетку всегда можно обойти
+};
+
+const PatternTables& patternTables();
+
+// Степени тройки: вклад соседа в направлении d.
+constexpr int kPatternDigits[6] = {1, 3, 9, 27, 81, 243};
+
+// Код окрестности с точки зрения X по камням позиции.
+inline int neighborhoodCode(const PatternGeometry& pg, const Bitboard& xStones, const Bitboard& oStones,
+                            int cells, int cell) {
+    int code = pg.edgeCode[cell];
+    for (int d = 0; d < 6; ++d) {
+        const int nb = pg.ring[cell][d];
+        if (nb < cells) code += (xStones.test(nb) ? 1 : oStones.test(nb) ? 2 : 0) * kPatternDigits[d];
+    }
+    return code;
+}
+
+// Камень цвета color (colorIndex) в клетке cell меняет коды X всех её
+// соседей: для соседа в направлении d клетка лежит в направлении (d + 3) % 6.
+// Массив codes должен вмещать и узлы за доской, cells + 3 элементов.
+inline void addStoneToCodes(const PatternGeometry& pg, int16_t* codes, int cell, int color) {
+    for (int d = 0; d < 6; ++d) {
+        codes[pg.ring[cell][d]] += static_cast<int16_t>((color + 1) * kPatternDigits[(d + 3) % 6]);
+    }
+}
+
+#endif // HEXCORE_PATTERNS_H
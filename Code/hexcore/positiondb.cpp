@@ -0,0 +1,146 @@
+#include "positiondb.h"
+
+#include "engine.h"
+#include "openingbook.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+struct DbHeader {
+    char magic[8];
+    uint32_t slotSize;
+    uint32_t reserved;
+    uint64_t capacity;
+    std::atomic<uint64_t> used;
+};
+
+constexpr char kDbMagic[8] = {'H', 'E', 'X', 'P', 'O', 'S', 'D', '1'};
+constexpr size_t kMinCapacity = 1024;
+
+static_assert(sizeof(DbHeader) == 32, "формат файла базы позиций");
+// Счётчики в файле делят несколько процессов — только без блокировок.
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "атомарные счётчики в общей памяти");
+
+// Ноль отмечает свободную ячейку; позиции с нулевым ключом достаётся другой.
+uint64_t slotKey(uint64_t key) {
+    return key ? key : 1;
+}
+
+} // namespace
+
+bool PositionDB::create(const std::string& path, size_t capacity) {
+    size_t slotCount = kMinCapacity;
+    while (slotCount < capacity) slotCount <<= 1;
+
+    static_assert(sizeof(Slot) == 16, "формат файла базы позиций");
+    DbHeader header = {};
+    std::memcpy(header.magic, kDbMagic, sizeof(kDbMagic));
+    header.slotSize = sizeof(Slot);
+    header.capacity = slotCount;
+
+    // Ячейки не пишутся: файл дополняется нулями до полного размера, и
+    // система не выделяет место под нетронутые страницы.
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.seekp(static_cast<std::streamoff>(sizeof(DbHeader) + slotCount * sizeof(Slot) - 1));
+    out.put('\0');
+    return static_cast<bool>(out);
+}
+
+bool PositionDB::open(const std::string& path, bool forWriting) {
+    close();
+    if (!file.open(path, forWriting) || file.size() < sizeof(DbHeader)) {
+        close();
+        return false;
+    }
+    auto* header = static_cast<DbHeader*>(file.data());
+    const uint64_t count = header->capacity;
+    if (std::memcmp(header->magic, kDbMagic, sizeof(kDbMagic)) != 0 || header->slotSize != sizeof(Slot) ||
+        count < kMinCapacity || (count & (count - 1)) != 0 ||
+        (file.size() - sizeof(DbHeader)) / sizeof(Slot) < count) {
+        close();
+        return false;
+    }
+    slots = reinterpret_cast<Slot*>(static_cast<char*>(file.data()) + sizeof(DbHeader));
+    used = &header->used;
+    mask = count - 1;
+    maxUsed = count / 4 * 3;
+    writable = forWriting;
+    return true;
+}
+
+void PositionDB::close() {
+    file.close();
+    slots = nullptr;
+    used = nullptr;
+    mask = 0;
+    maxUsed = 0;
+    writable = false;
+}
+
+size_t PositionDB::size() const {
+    return used ? static_cast<size_t>(used->load(std::memory_order_relaxed)) : 0;
+}
+
+bool PositionDB::lookup(const HexGame& game, PositionStats& stats) const {
+    return lookup(bookKey(game), stats);
+}
+
+bool PositionDB::lookup(uint64_t key, PositionStats& stats) const {
+    if (!slots) return false;
+    key = slotKey(key);
+    for (int probe = 0; probe < kMaxProbe; ++probe) {
+        const Slot& slot = slots[(key + probe) & mask];
+        const uint64_t stored = slot.key.load(std::memory_order_acquire);
+        if (stored == 0) return false;   // ячейки не освобождаются, дальше ключа нет
+        if (stored == key) {
+            stats.visits = slot.visits.load(std::memory_order_relaxed);
+            stats.wins = slot.wins.load(std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PositionDB::add(const HexGame& game, bool sideToMoveWon) {
+    return add(bookKey(game), 1, sideToMoveWon ? 1 : 0);
+}
+
+bool PositionDB::add(uint64_t key, uint32_t visits, uint32_t wins) {
+    if (!slots || !writable) return false;
+    key = slotKey(key);
+    for (int probe = 0; probe < kMaxProbe; ++probe) {
+        Slot& slot = slots[(key + probe) & mask];
+        uint64_t stored = slot.key.load(std::memory_order_acquire);
+        if (stored == 0) {
+            // Новые ключи не занимают последнюю четверть таблицы, чтобы
+            // цепочки проб оставались короткими.
+            if (used->load(std::memory_order_relaxed) >= maxUsed) return false;
+            if (slot.key.compare_exchange_strong(stored, key, std::memory_order_acq_rel)) {
+                used->fetch_add(1, std::memory_order_relaxed);
+                stored = key;
+            }
+            // Иначе ячейку занял другой писатель — возможно, тем же ключом.
+        }
+        if (stored == key) {
+            slot.visits.fetch_add(visits, std::memory_order_relaxed);
+            slot.wins.fetch_add(wins, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+int PositionDB::addGame(const GameRecord& record) {
+    if (!record.winner || record.size < 1 || record.size > kMaxBoardSize) return 0;
+    HexGame game(record.size, record.swapRule);
+    int missed = 0;
+    for (const Move& move : record.moves) {
+        if (!add(game, sideToMove(game) == record.winner)) ++missed;
+        if (!applyMove(game, move)) break;
+    }
+    return missed;
+}
@@ -0,0 +1,69 @@
+#ifndef HEXCORE_POSITIONDB_H
+#define HEXCORE_POSITIONDB_H
+
+#include "gamerecord.h"
+#include "hexgame.h"
+#include "mappedfile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Исход партий через позицию.
+struct PositionStats {
+    uint32_t visits = 0;      // партий через позицию
+    uint32_t wins = 0;        // из них выиграла сторона, которая в позиции ходит
+
+    double winRate() const { return visits ? static_cast<double>(wins) / visits : 0.5; }
+};
+
+// База позиций сыгранных партий: хэш-таблица с открытой адресацией в
+// отображённом в память файле. Ключ — bookKey (канонический хэш с учётом
+// поворота доски, размера и права обмена), ячейка — ключ и два счётчика,
+// 16 байт. Ёмкость задаётся при создании файла и не меняется, поэтому
+// память ограничена размером файла, а поиск просматривает не больше
+// kMaxProbe соседних ячеек. Ячейки занимаются и счётчики растут атомарно:
+// дописывать могут сразу несколько потоков и процессов, открывших файл.
+class PositionDB {
+public:
+    static constexpr size_t kDefaultCapacity = size_t(1) << 24;
+    static constexpr int kMaxProbe = 64;
+
+    // Новый пустой файл; ёмкость округляется вверх до степени двойки.
+    // Занято будет не больше трёх четвертей ячеек.
+    static bool create(const std::string& path, size_t capacity = kDefaultCapacity);
+
+    bool open(const std::string& path, bool writable = false);
+    void close();
+    bool isOpen() const { return slots != nullptr; }
+    size_t size() const;
+    size_t capacity() const { return slots ? mask + 1 : 0; }
+
+    // false — позиции нет.
+    bool lookup(const HexGame& game, PositionStats& stats) const;
+    bool lookup(uint64_t key, PositionStats& stats) const;
+
+    // false — база открыта только для чтения или заполнена.
+    bool add(const HexGame& game, bool sideToMoveWon);
+    bool add(uint64_t key, uint32_t visits, uint32_t wins);
+    // Все позиции законченной партии до последнего хода; возвращает число
+    // позиций, которые не поместились.
+    int addGame(const GameRecord& record);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key;       // 0 — свободна
+        std::atomic<uint32_t> visits;
+        std::atomic<uint32_t> wins;
+    };
+
+    Slot* slots = nullptr;
+    std::atomic<uint64_t>* used = nullptr;   // счётчик занятых ячеек в заголовке файла
+    uint64_t mask = 0;
+    uint64_t maxUsed = 0;
+    bool writable = false;
+    MappedFile file;
+};
+
+#endif // HEXCORE_POSITIONDB_H
@@ -0,0 +1,32 @@
+#include "scratch.h"
+
+#include <algorithm>
+#include <cstdint>
+
+ScratchArena::ScratchArena(size_t blockBytes) : blockBytes(blockBytes) {
+}
+
+void* ScratchArena::allocate(size_t bytes, size_t align) {
+    // Блок, где запрос не помещается, пропускается до следующего reset.
+    while (current < blocks.size()) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(blocks[current].data.get());
+        const size_t start = ((base + offset + align - 1) & ~(uintptr_t(align) - 1)) - base;
+        if (start + bytes <= blocks[current].size) {
+            offset = start + bytes;
+            return blocks[current].data.get() + start;
+        }
+        ++current;
+        offset = 0;
+    }
+    const size_t size = std::max(blockBytes, bytes + align);
+    blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    ++allocations;
+    current = blocks.size() - 1;
+    offset = 0;
+    return allocate(bytes, align);
+}
+
+void ScratchArena::reset() {
+    current = 0;
+    offset = 0;
+}
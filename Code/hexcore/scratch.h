@@ -0,0 +1,63 @@
+#ifndef HEXCORE_SCRATCH_H
+#define HEXCORE_SCRATCH_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Арена для буферов одного поиска: память выдаётся подряд из блоков и
+// возвращается вся сразу в reset, а блоки остаются для следующего поиска.
+// После разогрева поиск не обращается к куче; heapAllocations считает
+// взятые у кучи блоки, по нему это и проверяется. Арена принадлежит
+// движку, поэтому у каждого потока поиска своя.
+class ScratchArena {
+public:
+    explicit ScratchArena(size_t blockBytes = 256 * 1024);
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align);
+    // Всё выданное становится недействительным.
+    void reset();
+
+    size_t heapAllocations() const { return allocations; }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;     // блок, из которого идёт выдача
+    size_t offset = 0;
+    size_t blockBytes;
+    size_t allocations = 0;
+};
+
+// Распределитель для контейнеров в арене: освобождение ничего не делает,
+// память вернёт reset.
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(ScratchArena& arena) : arena(&arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    ScratchArena* arena;
+};
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // HEXCORE_SCRATCH_H
@@ -0,0 +1,223 @@
+#include "smarterai.h"
+
+#include "inferior.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+using std::pair;
+
+namespace {
+
+constexpr int kWinScore = 100000;
+constexpr int kWinBound = kWinScore - 1000;   // выше — найденная победа
+constexpr int kPruneDepth = 2;                // с этой глубины отбрасываются худшие клетки
+constexpr int kIterationGrowth = 4;           // во сколько раз следующая итерация дольше прошлой
+constexpr int kClockCheckInterval = 1024;     // проверок outOfTime между чтениями часов
+
+// Оценки побед зависят от расстояния до корня; в таблице они хранятся
+// относительно узла, чтобы запись подходила при любом пути к позиции.
+int scoreToTable(int score, int ply) {
+    if (score > kWinBound) return score + ply;
+    if (score < -kWinBound) return score - ply;
+    return score;
+}
+
+int scoreFromTable(int score, int ply) {
+    if (score > kWinBound) return score - ply;
+    if (score < -kWinBound) return score + ply;
+    return score;
+}
+
+} // namespace
+
+pair<int, int> SmarterAI::chooseMove(HexGame& game) {
+    const int N = game.getSize();
+    if (orderedSize != N) {
+        cellOrder.resize(N * N);
+        for (int i = 0; i < N * N; ++i) cellOrder[i] = static_cast<int16_t>(i);
+        auto centerDist = [N](int idx) {
+            return std::abs(2 * (idx / N) - (N - 1)) + std::abs(2 * (idx % N) - (N - 1));
+        };
+        std::stable_sort(cellOrder.begin(), cellOrder.end(),
+                         [&](int a, int b) { return centerDist(a) < centerDist(b); });
+        // Ключи не зависят от размера доски — записи другого размера мешали бы.
+        if (orderedSize != 0) table.clear();
+        orderedSize = N;
+    }
+
+    table.newSearch();
+    timeUp = false;
+    nodes = 0;
+    clockCountdown = 0;
+    completedDepth = 0;
+
+    // Доказанный выигрыш играется без перебора; полусоединения соперника
+    // оставляют в корне только ходы, которые их разрушают.
+    Bitboard allowed = findInferiorCells(game).movesFor(playerChar);
+    timing.start(game, timeLimitMs, clockMs, allowed.count());
+    if (solverMs > 0 && sideToMove(game) == playerChar) {
+        SolverLimits solverLimits = solver.solverLimits();
+        solverLimits.timeMs = timing.limited() ? std::min(solverMs, std::max(1, timing.softMs() / 4)) : solverMs;
+        solver.setLimits(solverLimits);
+        const SolveResult solved = solver.solve(game);
+        if (solved.status == kSolveWin && solved.move >= 0) return std::make_pair(solved.move / N, solved.move % N);
+        if (solved.mustPlay.any()) {
+            const Bitboard both = allowed & solved.mustPlay;
+            allowed = both.any() ? both : solved.mustPlay;
+        }
+    }
+
+    int bestCell = -1;
+    for (int idx : cellOrder) {
+        if (allowed.test(idx)) {
+            bestCell = idx;
+            break;
+        }
+    }
+    if (bestCell < 0) return std::make_pair(-1, -1);
+    if (allowed.count() == 1) return std::make_pair(bestCell / N, bestCell % N);
+
+    const int depthLimit = maxDepth > 0 ? maxDepth : (timing.limited() ? game.emptyCells().count() : 1);
+    for (int depth = 1; depth <= depthLimit; ++depth) {
+        const int iterationStart = timing.elapsedMs();
+        int alpha = INT_MIN;
+        int iterationBest = -1;
+        // Лучший ход прошлой итерации идёт первым.
+        for (int k = -1; k < N * N; ++k) {
+            int idx = k < 0 ? bestCell : cellOrder[k];
+            if (k >= 0 && idx == bestCell) continue;
+            if (!allowed.test(idx)) continue;
+            game.makeMove(idx / N, idx % N, playerChar);
+            int score = minimax(game, depth - 1, 1, false, alpha, INT_MAX);
+            game.undoMove(idx / N, idx % N);
+            if (timeUp) break;
+            if (iterationBest < 0 || score > alpha) {
+                alpha = score;
+                iterationBest = idx;
+            }
+        }
+        if (timeUp) break;
+        bestCell = iterationBest;
+        completedDepth = depth;
+        table.store(game.hash(), depth, kBoundExact, scoreToTable(alpha, 0), bestCell);
+        if (alpha > kWinBound || alpha < -kWinBound) break;
+        // Итерация, которая не успеет до жёсткого срока, была бы выброшена.
+        timing.noteBest(bestCell);
+        if (timing.shouldStop() ||
+            (timing.limited() && (timing.elapsedMs() - iterationStart) * kIterationGrowth > timing.remainingMs()))
+            break;
+    }
+    return std::make_pair(bestCell / N, bestCell % N);
+}
+
+Move SmarterAI::think(const Position& position, const SearchLimits& limits) {
+    const char side = sideToMove(position);
+    if (side != playerChar) {
+        // Оценки в таблице записаны со стороны прежнего цвета.
+        playerChar = side;
+        opponentChar = opponentOf(side);
+        if (orderedSize != 0) table.clear();
+    }
+    const int savedDepth = maxDepth;
+    const int savedTime = timeLimitMs;
+    if (limits.depth > 0) maxDepth = limits.depth;
+    if (limits.timeMs > 0) timeLimitMs = limits.timeMs;
+    clockMs = limits.remainingMs;
+    stop = limits.stop;
+    HexGame work = position;
+    auto move = chooseMove(work);
+    maxDepth = savedDepth;
+    timeLimitMs = savedTime;
+    stop = nullptr;
+    clockMs = 0;
+    return {move.first, move.second};
+}
+
+bool SmarterAI::outOfTime() {
+    // Свой счётчик, а не nodes: листья и отсечения по таблице тоже
+    // считаются узлами, и кратность nodes проскакивала бы.
+    if (--clockCountdown <= 0) {
+        clockCountdown = kClockCheckInterval;
+        if (timing.hardExpired()) timeUp = true;
+        if (stop && stop->load(std::memory_order_relaxed)) timeUp = true;
+    }
+    return timeUp;
+}
+
+int SmarterAI::minimax(HexGame& game, int depth, int ply, bool isMaximizing, int alpha, int beta) {
+    ++nodes;
+    if (game.checkWin(playerChar)) return kWinScore - ply;
+    if (game.checkWin(opponentChar)) return -kWinScore + ply;
+    if (depth == 0 || game.isFull()) return evaluateBoard(game);
+    if (outOfTime()) return 0;
+
+    const uint64_t key = game.hash();
+    const int alphaOrig = alpha;
+    const int betaOrig = beta;
+    int ttMove = -1;
+    TTEntry entry;
+    if (table.probe(key, entry)) {
+        ttMove = entry.move;
+        if (entry.depth >= depth) {
+            int score = scoreFromTable(entry.score, ply);
+            if (entry.bound == kBoundExact) return score;
+            if (entry.bound == kBoundLower) alpha = std::max(alpha, score);
+            else if (entry.bound == kBoundUpper) beta = std::min(beta, score);
+            if (alpha >= beta) return score;
+        }
+    }
+
+    const int N = game.getSize();
+    int bestScore = isMaximizing ? INT_MIN : INT_MAX;
+    int bestMove = -1;
+    // Над листьями анализ клеток дороже, чем отсечённые им оценки.
+    const Bitboard moves = depth >= kPruneDepth
+                               ? findInferiorCells(game).movesFor(isMaximizing ? playerChar : opponentChar)
+                               : game.emptyCells();
+
+    // Сначала ход из таблицы, затем остальные от центра к краям.
+    for (int k = -1; k < N * N; ++k) {
+        int idx = k < 0 ? ttMove : cellOrder[k];
+        if (idx < 0 || (k >= 0 && idx == ttMove)) continue;
+        int r = idx / N, c = idx % N;
+        if (!moves.test(idx)) continue;
+        game.makeMove(r, c, isMaximizing ? playerChar : opponentChar);
+        int score = minimax(game, depth - 1, ply + 1, !isMaximizing, alpha, beta);
+        game.undoMove(r, c);
+        if (timeUp) return 0;
+
+        if (isMaximizing ? score > bestScore : score < bestScore) {
+            bestScore = score;
+            bestMove = idx;
+        }
+        if (isMaximizing) alpha = std::max(alpha, bestScore);
+        else beta = std::min(beta, bestScore);
+        if (beta <= alpha) break;
+    }
+
+    TTBound bound = kBoundExact;
+    if (bestScore <= alphaOrig) bound = kBoundUpper;
+    else if (bestScore >= betaOrig) bound = kBoundLower;
+    table.store(key, depth, bound, scoreToTable(bestScore, ply), bestMove);
+    return bestScore;
+}
+
+int SmarterAI::evaluateBoard(const HexGame& game) {
+    return scorePlayer(game, playerChar) - scorePlayer(game, opponentChar);
+}
+
+int SmarterAI::scorePlayer(const HexGame& game, char player) {
+    // 5 за камень и 3 за каждого соседа своего цвета (пара считается дважды).
+    const Bitboard& own = game.stonesOf(player);
+    const BoardGeometry& geo = game.geometry();
+    int score = 0;
+    own.forEach([&](int idx) {
+        score += 5;
+        for (int nb : geo.neighbors[idx]) {
+            if (nb >= 0 && own.test(nb)) score += 3;
+        }
+    });
+    return score;
+}
@@ -0,0 +1,65 @@
+#ifndef HEXCORE_SMARTERAI_H
+#define HEXCORE_SMARTERAI_H
+
+#include "engine.h"
+#include "hexgame.h"
+#include "hsearch.h"
+#include "timemanager.h"
+#include "transposition.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Альфа-бета с итеративным углублением до depth. Таблица транспозиций
+// по хэшу Zobrist отсекает повторы позиций и даёт ход для сортировки на
+// следующей итерации, а между ходами сохраняется: ответ соперника
+// обычно уже перебран прошлым поиском. При лимите времени timeMs (0 — без
+// лимита) берётся ход последней завершённой итерации; новая итерация не
+// начинается после мягкого срока (timemanager.h) и когда по времени
+// прошлой она не успеет до жёсткого. depth 0 при лимите — углубление, пока хватает времени.
+// Единственный допустимый ход играется без перебора. Перед перебором
+// корень проверяет решатель по виртуальным соединениям, как в MctsAI;
+// заведомо худшие ходы (inferior.h) не перебираются ни в одном узле.
+class SmarterAI : public Engine {
+public:
+    SmarterAI(char aiChar, int depth = 2, int timeMs = 0)
+        : playerChar(aiChar), opponentChar(opponentOf(aiChar)), maxDepth(depth), timeLimitMs(timeMs) {}
+
+    std::pair<int, int> chooseMove(HexGame& game);
+    // Играет за сторону, которая ходит в position; depth, timeMs и
+    // remainingMs из limits заменяют настройки на один поиск.
+    Move think(const Position& position, const SearchLimits& limits) override;
+
+    // Время решателя, не больше четверти мягкого срока; 0 — без решателя.
+    void setSolverMs(int ms) { solverMs = ms; }
+
+    int lastDepth() const { return completedDepth; }
+    long lastNodes() const { return nodes; }
+
+private:
+    char playerChar;
+    char opponentChar;
+    int maxDepth;
+    int timeLimitMs;
+    int clockMs = 0;                  // остаток часов на партию
+    int solverMs = 100;
+
+    TranspositionTable table;
+    VcSolver solver;
+    std::vector<int16_t> cellOrder;   // клетки от центра к краям
+    int orderedSize = 0;
+    TimeManager timing;
+    bool timeUp = false;
+    const std::atomic<bool>* stop = nullptr;
+    int completedDepth = 0;
+    long nodes = 0;
+    int clockCountdown = 0;           // до следующего чтения часов
+
+    int minimax(HexGame& game, int depth, int ply, bool isMaximizing, int alpha, int beta);
+    int evaluateBoard(const HexGame& game);
+    int scorePlayer(const HexGame& game, char player);
+    bool outOfTime();
+};
+
+#endif // HEXCORE_SMARTERAI_H
@@ -0,0 +1,76 @@
+#include "timemanager.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kMaxMarginMs = 50;        // запас до предела на возврат хода
+constexpr double kClockShare = 0.3;     // больше этой доли часов один ход не берёт
+constexpr int kMinMovesLeft = 8;
+constexpr double kMinComplexity = 0.3;  // мягкий срок при единственных разумных ходах
+
+using std::chrono::milliseconds;
+
+} // namespace
+
+void TimeManager::start(const HexGame& position, int moveTimeMs, int remainingMs, int candidates) {
+    begin = Clock::now();
+    best = -1;
+    bestSince = begin;
+    int limitMs = moveTimeMs > 0 ? moveTimeMs : 0;
+    if (remainingMs > 0) {
+        const int share = std::max(1, static_cast<int>(remainingMs * kClockShare));
+        limitMs = limitMs > 0 ? std::min(limitMs, share) : share;
+    }
+    hasLimit = limitMs > 0;
+    if (!hasLimit) return;
+
+    const int hardMs = std::max(1, limitMs - std::min(kMaxMarginMs, limitMs / 10));
+    // Без часов на партию сэкономленное время пропадает, поэтому мягкий
+    // срок урезается только сложностью позиции.
+    double softBase = hardMs;
+    if (remainingMs > 0) {
+        // Примерно половина пустых клеток достанется нам, но партия
+        // обычно решается раньше, чем доска заполнится.
+        const int movesLeft = std::max(kMinMovesLeft, position.emptyCells().count() / 4);
+        softBase = std::min(softBase, static_cast<double>(remainingMs) / movesLeft);
+    }
+    const int cells = position.getSize() * position.getSize();
+    const double breadth = std::min(1.0, 3.0 * std::max(1, candidates) / cells);
+    const int softTargetMs = std::max(1, static_cast<int>(softBase * (kMinComplexity + (1.0 - kMinComplexity) * breadth)));
+
+    hard = begin + milliseconds(hardMs);
+    softSpan = milliseconds(softTargetMs);
+    soft = begin + softSpan;
+    extended = begin + std::min<Clock::duration>(milliseconds(hardMs), 2 * softSpan);
+    if (remainingMs <= 0) extended = hard;
+}
+
+int TimeManager::softMs() const {
+    return static_cast<int>(std::chrono::duration_cast<milliseconds>(softSpan).count());
+}
+
+int TimeManager::elapsedMs() const {
+    return static_cast<int>(std::chrono::duration_cast<milliseconds>(Clock::now() - begin).count());
+}
+
+int TimeManager::remainingMs() const {
+    if (!hasLimit) return 0;
+    return static_cast<int>(std::max<long long>(0, std::chrono::duration_cast<milliseconds>(hard - Clock::now()).count()));
+}
+
+void TimeManager::noteBest(int move) {
+    if (move == best) return;
+    best = move;
+    bestSince = Clock::now();
+}
+
+bool TimeManager::shouldStop() const {
+    if (!hasLimit) return false;
+    const auto now = Clock::now();
+    if (now >= hard) return true;
+    const auto stable = now - bestSince;
+    if (now >= soft) return stable >= softSpan / 4 || now >= extended;
+    // Ход, не менявшийся три четверти мягкого срока, вряд ли сменится до его конца.
+    return stable >= softSpan * 3 / 4;
+}
@@ -0,0 +1,45 @@
+#ifndef HEXCORE_TIMEMANAGER_H
+#define HEXCORE_TIMEMANAGER_H
+
+#include "hexgame.h"
+
+#include <chrono>
+
+// Время на один ход. Жёсткий срок поиск не нарушает: к нему уже должен
+// быть возвращён лучший найденный ход, поэтому срок взят с запасом.
+// Мягкий срок — обычная цель: доля часов на оставшиеся ходы (без часов —
+// весь предел), урезанная в простых позициях, где разумных ходов мало.
+// Лучший ход, который давно не меняется, заканчивает поиск раньше; только
+// что сменившийся продлевает его после мягкого срока, но не дальше двух
+// мягких и жёсткого.
+class TimeManager {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // moveTimeMs — предел на ход, remainingMs — остаток часов на партию;
+    // 0 — предела нет. candidates — число разумных ходов в позиции.
+    void start(const HexGame& position, int moveTimeMs, int remainingMs, int candidates);
+
+    bool limited() const { return hasLimit; }
+    bool hardExpired() const { return hasLimit && Clock::now() >= hard; }
+    Clock::time_point hardDeadline() const { return hard; }
+    int softMs() const;
+    int elapsedMs() const;
+    int remainingMs() const;      // до жёсткого срока
+
+    // Лучший ход на очередной проверке поиска.
+    void noteBest(int move);
+    bool shouldStop() const;
+
+private:
+    bool hasLimit = false;
+    Clock::time_point begin;
+    Clock::time_point soft;
+    Clock::time_point extended;   // крайний срок продления после мягкого
+    Clock::time_point hard;
+    Clock::duration softSpan{};
+    int best = -1;
+    Clock::time_point bestSince;
+};
+
+#endif // HEXCORE_TIMEMANAGER_H
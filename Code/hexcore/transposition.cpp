@@ -0,0 +1,64 @@
+#include "transposition.h"
+
+namespace {
+
+// Упаковка записи в 64 бита:
+// score 32 | move 16 | depth 8 | bound 2 | generation 6.
+uint64_t pack(int score, int move, int depth, TTBound bound, uint8_t generation) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(score)) << 32 |
+           static_cast<uint64_t>(static_cast<uint16_t>(move)) << 16 |
+           static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 8 |
+           static_cast<uint64_t>(bound) << 6 | generation;
+}
+
+int unpackScore(uint64_t data) { return static_cast<int32_t>(data >> 32); }
+int unpackMove(uint64_t data) { return static_cast<int16_t>(data >> 16); }
+int unpackDepth(uint64_t data) { return static_cast<uint8_t>(data >> 8); }
+TTBound unpackBound(uint64_t data) { return static_cast<TTBound>((data >> 6) & 3); }
+uint8_t unpackGeneration(uint64_t data) { return data & 0x3F; }
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024) count *= 2;
+    slots = std::make_unique<Slot[]>(count);
+    mask = count - 1;
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Slot& slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || unpackBound(data) == kBoundNone) return false;
+    entry.score = unpackScore(data);
+    entry.move = unpackMove(data);
+    entry.depth = unpackDepth(data);
+    entry.bound = unpackBound(data);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, TTBound bound, int score, int move) {
+    Slot& slot = slots[key & mask];
+    uint64_t old = slot.data.load(std::memory_order_relaxed);
+    bool sameKey = (slot.check.load(std::memory_order_relaxed) ^ old) == key;
+    if (unpackBound(old) != kBoundNone) {
+        // Более глубокую запись текущего поиска не затираем.
+        if (unpackGeneration(old) == generation && unpackDepth(old) > depth) return;
+        if (sameKey && move < 0) move = unpackMove(old);
+    }
+    uint64_t data = pack(score, move, depth, bound, generation);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
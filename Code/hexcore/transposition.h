@@ -0,0 +1,44 @@
+#ifndef HEXCORE_TRANSPOSITION_H
+#define HEXCORE_TRANSPOSITION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum TTBound : uint8_t { kBoundNone = 0, kBoundExact = 1, kBoundLower = 2, kBoundUpper = 3 };
+
+struct TTEntry {
+    int score = 0;
+    int depth = 0;
+    TTBound bound = kBoundNone;
+    int move = -1;          // индекс клетки или -1
+};
+
+// Таблица транспозиций фиксированного размера без блокировок: в слоте
+// хранится data и key ^ data. Если другой поток перезаписал слот между
+// двумя чтениями, проверка ключа не сойдётся и запись просто не найдётся.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    void resize(size_t megabytes);
+    void clear();
+    // Новое поколение: записи прошлых поисков вытесняются в первую очередь.
+    void newSearch() { generation = static_cast<uint8_t>((generation + 1) & 0x3F); }
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int depth, TTBound bound, int score, int move);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{0};   // key ^ data
+        std::atomic<uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    uint8_t generation = 0;
+};
+
+#endif // HEXCORE_TRANSPOSITION_H
@@ -0,0 +1,31 @@
+#ifndef HEXCORE_ZOBRIST_H
+#define HEXCORE_ZOBRIST_H
+
+#include "bitboard.h"
+
+#include <cstdint>
+
+// Перемешивание splitmix64: из номера получается независимый 64-битный ключ.
+constexpr uint64_t mixKey(uint64_t x) {
+    uint64_t z = 0x4845585A4F425249ull + (x + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Ключи Zobrist: хэш позиции — xor ключей всех камней. Ключ зависит только
+// от цвета и индекса клетки, а не от HEXCORE_MAX_BOARD_SIZE, поэтому хэши
+// одинаковы во всех сборках и могут храниться в файлах.
+struct ZobristKeys {
+    uint64_t stone[2][kMaxCells];
+
+    constexpr ZobristKeys() : stone{} {
+        for (int color = 0; color < 2; ++color) {
+            for (int idx = 0; idx < kMaxCells; ++idx) stone[color][idx] = mixKey(uint64_t(color) << 16 | idx);
+        }
+    }
+};
+
+inline constexpr ZobristKeys kZobrist{};
+
+#endif // HEXCORE_ZOBRIST_H
@@ -1,6 +1,15 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-
+#include "aiworker.h"
+#include "hexboardwidget.h"
+#include "hexcore/analysis.h"
+#include "hexcore/gamehistory.h"
+#include "hexcore/gamerecord.h"
+#include "hexcore/heuristicai.h"
+#include "hexcore/hexgame.h"
+
+#include <QCheckBox>
+#include <QCoreApplication>
 #include <QMessageBox>
 #include <QTimer>
 #include <QRandomGenerator>
@@ -8,307 +17,58 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QGridLayout>
+#include <QSignalBlocker>
+#include <QSlider>
+#include <QStringList>
 #include <QInputDialog>
-#include <queue>
+#include <QThread>
+#include <algorithm>
 #include <vector>
-#include <limits>
-
-using std::vector;
-using std::pair;
-using std::queue;
-
-static const int kHexDirections[6][2] = {
-    {-1, 0}, {-1, 1}, {0, -1},
-    {0, 1}, {1, -1}, {1, 0}
-};
-
-class HexGame {
-public:
-    explicit HexGame(int size) : size(size), board(size, vector<char>(size, '.')) {}
-
-    bool makeMove(int r, int c, char player) {
-        if (r < 0 || r >= size || c < 0 || c >= size || board[r][c] != '.') return false;
-        board[r][c] = player;
-        return true;
-    }
-
-    void undoMove(int r, int c) {
-        if (r >= 0 && r < size && c >= 0 && c < size) board[r][c] = '.';
-    }
-
-    bool isCellEmpty(int r, int c) const {
-        return r >= 0 && r < size && c >= 0 && c < size && board[r][c] == '.';
-    }
-
-    bool checkWin(char player) const {
-        if (player == 'X') return hasHorizontalConnection();
-        if (player == 'O') return hasVerticalConnection();
-        return false;
-    }
-
-    bool isFull() const {
-        for (const auto& row : board)
-            for (char cell : row)
-                if (cell == '.') return false;
-        return true;
-    }
-
-    int getSize() const { return size; }
-    const vector<vector<char>>& getBoard() const { return board; }
-
-private:
-    int size;
-    vector<vector<char>> board;
-
-    bool hasHorizontalConnection() const {
-        vector<vector<bool>> visited(size, vector<bool>(size, false));
-        queue<pair<int,int>> q;
-        for (int r = 0; r < size; ++r) {
-            if (board[r][0] == 'X') {
-                q.push({r, 0});
-                visited[r][0] = true;
-            }
-        }
-        while (!q.empty()) {
-            auto cur = q.front(); q.pop();
-            int r = cur.first, c = cur.second;
-            if (c == size - 1) return true;
-            for (int d = 0; d < 6; ++d) {
-                int nr = r + kHexDirections[d][0];
-                int nc = c + kHexDirections[d][1];
-                if (nr >= 0 && nr < size && nc >= 0 && nc < size &&
-                    !visited[nr][nc] && board[nr][nc] == 'X') {
-                    visited[nr][nc] = true;
-                    q.push({nr, nc});
-                }
-            }
-        }
-        return false;
-    }
-
-    bool hasVerticalConnection() const {
-        vector<vector<bool>> visited(size, vector<bool>(size, false));
-        queue<pair<int,int>> q;
-        for (int c = 0; c < size; ++c) {
-            if (board[0][c] == 'O') {
-                q.push({0, c});
-                visited[0][c] = true;
-            }
-        }
-        while (!q.empty()) {
-            auto cur = q.front(); q.pop();
-            int r = cur.first, c = cur.second;
-            if (r == size - 1) return true;
-            for (int d = 0; d < 6; ++d) {
-                int nr = r + kHexDirections[d][0];
-                int nc = c + kHexDirections[d][1];
-                if (nr >= 0 && nr < size && nc >= 0 && nc < size &&
-                    !visited[nr][nc] && board[nr][nc] == 'O') {
-                    visited[nr][nc] = true;
-                    q.push({nr, nc});
-                }
-            }
-        }
-        return false;
-    }
-};
-
-int MainWindow::minMovesForXToWin(QVector<QPair<int,int>>* path) {
-    const auto& board = game->getBoard();
-    int size = boardSize;
-    const int n = size * size;
-    const int INF = 1'000'000'000;
-
-    auto id = [size](int r, int c) { return r * size + c; };
-    vector<int> dist(n, INF);
-    vector<int> parent(n, -1);
-    using Node = std::pair<int,int>;
-    std::priority_queue<Node, vector<Node>, std::greater<Node>> pq;
-
-    auto cellCost = [](char cell) -> int {
-        if (cell == 'O') return std::numeric_limits<int>::max() / 4;
-        return cell == 'X' ? 0 : 1;
-    };
-
-    for (int r = 0; r < size; ++r) {
-        int cost = cellCost(board[r][0]);
-        if (cost >= INF) continue;
-        int idx = id(r, 0);
-        dist[idx] = cost;
-        pq.push({dist[idx], idx});
-    }
-
-    while (!pq.empty()) {
-        auto [d, v] = pq.top();
-        pq.pop();
-        if (d != dist[v] || d >= INF) continue;
-        int r = v / size;
-        int c = v % size;
-        for (int dir = 0; dir < 6; ++dir) {
-            int nr = r + kHexDirections[dir][0];
-            int nc = c + kHexDirections[dir][1];
-            if (nr < 0 || nr >= size || nc < 0 || nc >= size) continue;
-            char cell = board[nr][nc];
-            if (cell == 'O') continue;
-            int add = (cell == 'X') ? 0 : 1;
-            int nv = id(nr, nc);
-            if (dist[nv] > d + add) {
-                dist[nv] = d + add;
-                parent[nv] = v;
-                pq.push({dist[nv], nv});
-            }
-        }
-    }
-
-    int bestIdx = -1;
-    int bestCost = INF;
-    for (int r = 0; r < size; ++r) {
-        int idx = id(r, size - 1);
-        if (dist[idx] < bestCost) {
-            bestCost = dist[idx];
-            bestIdx = idx;
-        }
-    }
-
-    if (path && bestIdx != -1 && bestCost < INF) {
-        QVector<QPair<int,int>> backtrack;
-        int cur = bestIdx;
-        while (cur != -1) {
-            int r = cur / size;
-            int c = cur % size;
-            if (board[r][c] == '.') backtrack.prepend({r, c});
-            cur = parent[cur];
-        }
-        *path = backtrack;
-    }
-
-    return bestCost >= INF ? INF : bestCost;
-}
-
-int MainWindow::minMovesForOToWin(QVector<QPair<int,int>>* path) {
-    const auto& board = game->getBoard();
-    int size = boardSize;
-    const int n = size * size;
-    const int INF = 1'000'000'000;
-
-    auto id = [size](int r, int c) { return r * size + c; };
-    vector<int> dist(n, INF);
-    vector<int> parent(n, -1);
-    using Node = std::pair<int,int>;
-    std::priority_queue<Node, vector<Node>, std::greater<Node>> pq;
-
-    auto cellCost = [](char cell) -> int {
-        if (cell == 'X') return std::numeric_limits<int>::max() / 4;
-        return cell == 'O' ? 0 : 1;
-    };
-
-    for (int c = 0; c < size; ++c) {
-        int cost = cellCost(board[0][c]);
-        if (cost >= INF) continue;
-        int idx = id(0, c);
-        dist[idx] = cost;
-        pq.push({dist[idx], idx});
-    }
-
-    while (!pq.empty()) {
-        auto [d, v] = pq.top();
-        pq.pop();
-        if (d != dist[v] || d >= INF) continue;
-        int r = v / size;
-        int c = v % size;
-        for (int dir = 0; dir < 6; ++dir) {
-            int nr = r + kHexDirections[dir][0];
-            int nc = c + kHexDirections[dir][1];
-            if (nr < 0 || nr >= size || nc < 0 || nc >= size) continue;
-            char cell = board[nr][nc];
-            if (cell == 'X') continue;
-            int add = (cell == 'O') ? 0 : 1;
-            int nv = id(nr, nc);
-            if (dist[nv] > d + add) {
-                dist[nv] = d + add;
-                parent[nv] = v;
-                pq.push({dist[nv], nv});
-            }
-        }
-    }
-
-    int bestIdx = -1;
-    int bestCost = INF;
-    for (int c = 0; c < size; ++c) {
-        int idx = id(size - 1, c);
-        if (dist[idx] < bestCost) {
-            bestCost = dist[idx];
-            bestIdx = idx;
-        }
-    }
-
-    if (path && bestIdx != -1 && bestCost < INF) {
-        QVector<QPair<int,int>> backtrack;
-        int cur = bestIdx;
-        while (cur != -1) {
-            int r = cur / size;
-            int c = cur % size;
-            if (board[r][c] == '.') backtrack.prepend({r, c});
-            cur = parent[cur];
-        }
-        *path = backtrack;
-    }
-
-    return bestCost >= INF ? INF : bestCost;
-}
-
-bool MainWindow::isXOneMoveFromWin() {
-    int minMoves = minMovesForXToWin(nullptr);
-    return minMoves <= 1;
-}
-
-bool MainWindow::isXTwoMovesFromWin() {
-    int minMoves = minMovesForXToWin(nullptr);
-    return minMoves <= 2;
-}
-
-int MainWindow::shortestPathToConnectO(int r, int c) {
-    const auto& board = game->getBoard();
-    int size = boardSize;
-    int distToTop = r;
-    int distToBottom = size - 1 - r;
-    int xNearby = 0;
-    for (int d = 0; d < 6; ++d) {
-        int nr = r + kHexDirections[d][0];
-        int nc = c + kHexDirections[d][1];
-        if (nr >= 0 && nr < size && nc >= 0 && nc < size && board[nr][nc] == 'X') {
-            xNearby++;
-        }
-    }
-    return distToTop + distToBottom + xNearby * 2;
-}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , game(nullptr)
+    , history(nullptr)
     , boardSize(7)
     , currentPlayer('X')
     , vsAI(true)
+    , aiPlayer('O')
     , statusLabel(nullptr)
-    , gameGrid(nullptr)
-    , aiFirstMove(true)
+    , analysisLabel(nullptr)
+    , board(nullptr)
+    , undoButton(nullptr)
+    , redoButton(nullptr)
+    , moveSlider(nullptr)
+    , moveLabel(nullptr)
     , turnTimer(nullptr)
+    , analysisBox(nullptr)
+    , analysisTimer(nullptr)
     , remainingSeconds(5)
-    , lastXRow(-1)
-    , lastXCol(-1)
     , gameOver(false)
+    , aiThread(nullptr)
+    , aiWorker(nullptr)
+    , aiGeneration(0)
+    , aiThinking(false)
 {
     ui->setupUi(this);
+    aiThread = new QThread(this);
+    aiWorker = new AIWorker;
+    aiWorker->moveToThread(aiThread);
+    connect(aiThread, &QThread::finished, aiWorker, &QObject::deleteLater);
+    connect(aiWorker, &AIWorker::moveReady, this, &MainWindow::onAIMoveReady, Qt::QueuedConnection);
+    aiThread->start();
     setupUI();
     showIntro();
-    game = new HexGame(boardSize);
+    history = new GameHistory(HexGame(boardSize));
+    updateHistoryControls();
     newGame();
 }
 
 MainWindow::~MainWindow() {
-    delete game;
+    cancelAISearch();
+    aiThread->quit();
+    aiThread->wait();
+    delete history;
     delete ui;
 }
 
@@ -326,16 +86,43 @@ void MainWindow::setupUI() {
     statusLabel->setAlignment(Qt::AlignCenter);
     statusLabel->setStyleSheet("font-size: 16px; color: #FF4444; padding: 6px;");
     mainLayout->addWidget(statusLabel);
-    gameGrid = new QGridLayout();
-    gameGrid->setSpacing(2);
-    gameGrid->setContentsMargins(0, 0, 0, 0);
-    mainLayout->addLayout(gameGrid, 1);
+    analysisLabel = new QLabel();
+    analysisLabel->setAlignment(Qt::AlignCenter);
+    analysisLabel->setStyleSheet("font-size: 13px; color: #AAAAAA;");
+    analysisLabel->hide();
+    mainLayout->addWidget(analysisLabel);
+    board = new HexBoardWidget();
+    mainLayout->addWidget(board, 1);
+    connect(board, &HexBoardWidget::cellClicked, this, &MainWindow::onCellClicked);
+    // История: отмена, возврат и ползунок перехода к любому ходу партии.
+    QHBoxLayout* historyLayout = new QHBoxLayout();
+    undoButton = new QPushButton("◀ Отменить");
+    undoButton->setShortcut(QKeySequence::Undo);
+    redoButton = new QPushButton("Вернуть ▶");
+    redoButton->setShortcut(QKeySequence::Redo);
+    moveSlider = new QSlider(Qt::Horizontal);
+    moveSlider->setTracking(false);   // переход — когда ползунок отпущен
+    moveLabel = new QLabel();
+    historyLayout->addWidget(undoButton);
+    historyLayout->addWidget(moveSlider, 1);
+    historyLayout->addWidget(moveLabel);
+    historyLayout->addWidget(redoButton);
+    mainLayout->addLayout(historyLayout);
+    connect(undoButton, &QPushButton::clicked, this, &MainWindow::undoMove);
+    connect(redoButton, &QPushButton::clicked, this, &MainWindow::redoMove);
+    connect(moveSlider, &QSlider::valueChanged, this, &MainWindow::jumpToMove);
     QHBoxLayout* buttonsLayout = new QHBoxLayout();
     QPushButton* newGameBtn = new QPushButton("Новая игра");
     QPushButton* menuBtn = new QPushButton("Правила");
+    analysisBox = new QCheckBox("Анализ ИИ");
     buttonsLayout->addWidget(newGameBtn);
     buttonsLayout->addWidget(menuBtn);
+    buttonsLayout->addWidget(analysisBox);
     mainLayout->addLayout(buttonsLayout);
+    analysisTimer = new QTimer(this);
+    analysisTimer->setInterval(100);
+    connect(analysisTimer, &QTimer::timeout, this, &MainWindow::showAnalysis);
+    connect(analysisBox, &QCheckBox::toggled, this, &MainWindow::setAnalysisEnabled);
     connect(newGameBtn, &QPushButton::clicked, this, &MainWindow::newGame);
     connect(menuBtn, &QPushButton::clicked, this, &MainWindow::showMenu);
 }
@@ -351,8 +138,9 @@ void MainWindow::showIntro() {
 
 void MainWindow::newGame() {
     bool ok = false;
-    int size = QInputDialog::getInt(this, "Размер поля", "Введите размер поля (7–11):",
-                                    boardSize, 7, 11, 1, &ok);
+    int size = QInputDialog::getInt(this, "Размер поля",
+                                    QString("Введите размер поля (7–%1):").arg(kMaxBoardSize),
+                                    boardSize, 7, kMaxBoardSize, 1, &ok);
     if (!ok) return;
 
     QMessageBox modeBox(this);
@@ -362,44 +150,27 @@ void MainWindow::newGame() {
     QPushButton* localBtn = modeBox.addButton("На двоих локально", QMessageBox::DestructiveRole);
     modeBox.exec();
     vsAI = (modeBox.clickedButton() == aiBtn);
+    if (vsAI) {
+        QMessageBox colorBox(this);
+        colorBox.setWindowTitle("Цвет");
+        colorBox.setText("За кого играешь?");
+        colorBox.addButton("X (ходит первым)", QMessageBox::AcceptRole);
+        QPushButton* oBtn = colorBox.addButton("O", QMessageBox::RejectRole);
+        colorBox.exec();
+        aiPlayer = (colorBox.clickedButton() == oBtn) ? 'X' : 'O';
+    }
 
+    cancelAISearch();
     boardSize = size;
-    aiFirstMove = true;
-    delete game;
-    game = new HexGame(boardSize);
+    history->reset(HexGame(boardSize));
     currentPlayer = 'X';
     gameOver = false;
-    lastXRow = -1;
-    lastXCol = -1;
-    buttons.assign(boardSize, vector<QPushButton*>(boardSize, nullptr));
-    QLayoutItem* item;
-    while ((item = gameGrid->takeAt(0)) != nullptr) {
-        delete item->widget();
-        delete item;
-    }
-    for (int r = 0; r < boardSize; ++r) {
-        for (int c = 0; c < boardSize; ++c) {
-            QPushButton* btn = new QPushButton("");
-            btn->setFixedSize(48, 48);
-            btn->setStyleSheet(
-                "QPushButton { "
-                "border: 2px solid #777; "
-                "border-radius: 24px; "
-                "background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #DDDDDD, stop:1 #AAAAAA); "
-                "font-size: 22px; font-weight: bold; "
-                "}"
-                "QPushButton:hover { "
-                "background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #EEEEEE, stop:1 #CCCCCC); "
-                "}");
-            buttons[r][c] = btn;
-            int visualCol = c + r;
-            gameGrid->addWidget(btn, r, visualCol);
-            connect(btn, &QPushButton::clicked, this, [this, r, c]() {
-                onCellClicked(r, c);
-            });
-        }
+    board->setBoardSize(boardSize);
+    updateHistoryControls();
+    if (vsAI && aiPlayer == 'X') {
+        triggerAIMove();
+        return;
     }
-    updateBoard();
     printStatus("Твой ход X");
     startTurnTimer("Твой ход X");
 }
@@ -415,17 +186,17 @@ void MainWindow::startTurnTimer(const QString& baseStatus) {
     turnTimer->start(1000);
 }
 
-bool MainWindow::placeRandomMove(char player, int& outR, int& outC) {
+bool MainWindow::placeRandomMove(int& outR, int& outC) {
     QVector<QPair<int,int>> emptyCells;
     for (int r = 0; r < boardSize; ++r) {
         for (int c = 0; c < boardSize; ++c) {
-            if (game->isCellEmpty(r, c)) emptyCells.append({r, c});
+            if (history->position().isCellEmpty(r, c)) emptyCells.append({r, c});
         }
     }
     if (emptyCells.isEmpty()) return false;
     auto cell = emptyCells[QRandomGenerator::global()->bounded(emptyCells.size())];
     outR = cell.first; outC = cell.second;
-    return game->makeMove(outR, outC, player);
+    return history->play({outR, outC});
 }
 
 void MainWindow::handleTimeout() {
@@ -439,22 +210,20 @@ void MainWindow::handleTimeout() {
     }
     turnTimer->stop();
     int r = -1, c = -1;
-    if (vsAI && currentPlayer == 'O') {
-        if (lastXRow == -1 || lastXCol == -1) {
-            placeRandomMove('X', lastXRow, lastXCol);
-            updateBoard();
-        }
-        triggerAIMove(lastXRow, lastXCol);
+    if (vsAI && currentPlayer == aiPlayer) {
+        if (aiThinking) return;   // ход придёт из потока ИИ
+        triggerAIMove();
         return;
     }
-    if (!placeRandomMove(currentPlayer, r, c)) return;
+    if (!placeRandomMove(r, c)) return;
     updateBoard();
-    if (currentPlayer == 'X') { lastXRow = r; lastXCol = c; }
-    if (game->checkWin(currentPlayer)) { printStatus(currentPlayer == 'X' ? "🎉 ПОБЕДИЛ X!" : "🎉 ПОБЕДИЛ O!"); return; }
-    if (game->isFull()) { printStatus("НИЧЬЯ!"); return; }
+    if (history->position().checkWin(currentPlayer)) {
+        finishGame(currentPlayer == 'X' ? "🎉 ПОБЕДИЛ X!" : "🎉 ПОБЕДИЛ O!");
+        return;
+    }
     currentPlayer = (currentPlayer == 'X') ? 'O' : 'X';
-    if (vsAI && currentPlayer == 'O') {
-        triggerAIMove(r, c);
+    if (vsAI && currentPlayer == aiPlayer) {
+        triggerAIMove();
     } else {
         QString msg = QString("Ход %1").arg(currentPlayer);
         startTurnTimer(msg);
@@ -462,332 +231,125 @@ void MainWindow::handleTimeout() {
     }
 }
 
-void MainWindow::triggerAIMove(int playerLastR, int playerLastC) {
+void MainWindow::triggerAIMove() {
     if (gameOver) return;
     QString threatStatus;
-    bool xOneMove = isXOneMoveFromWin();
-    bool xTwoMoves = isXTwoMovesFromWin();
-    if (xOneMove) threatStatus = "🚨 X в 1 ходе от победы!";
-    else if (xTwoMoves) threatStatus = "⚠️ X в 2 ходах от победы!";
+    const char human = opponentOf(aiPlayer);
+    const HexGame& game = history->position();
+    if (HeuristicAI::isOneMoveFromWin(game, human)) threatStatus = QString("🚨 %1 в 1 ходе от победы!").arg(human);
+    else if (HeuristicAI::isTwoMovesFromWin(game, human)) threatStatus = QString("⚠️ %1 в 2 ходах от победы!").arg(human);
     else threatStatus = "🧠 ИИ думает...";
     printStatus(threatStatus);
-    startTurnTimer("Ход O (ИИ)");
-    QTimer::singleShot(400, [this, playerLastR, playerLastC, xOneMove, xTwoMoves]() {
-        if (turnTimer) turnTimer->stop();
-        int bestR = -1, bestC = -1;
-        int bestScore = -1000000000;
-        const auto& boardSnap = game->getBoard();
-        QVector<QPair<int,int>> threatPath;
-        int threatCost = minMovesForXToWin(&threatPath);
-        QVector<QPair<int,int>> oPath;
-        int oPathCost = minMovesForOToWin(&oPath);
-        QVector<QPair<int,int>> emptyCells;
-        int cellCount = 0;
-        for (int r = 0; r < boardSize && cellCount < 50; ++r) {
-            for (int c = 0; c < boardSize && cellCount < 50; ++c) {
-                if (game->isCellEmpty(r, c)) {
-                    emptyCells.append({r, c});
-                    cellCount++;
-                }
-            }
-        }
-        // Если X выигрывает за 1 ход, ищем любой блокирующий ход (приоритет пути угрозы).
-        if (bestR == -1 && threatCost <= 1) {
-            // Сначала клетки из критического пути
-            for (const auto& cell : threatPath) {
-                int r = cell.first, c = cell.second;
-                if (!game->isCellEmpty(r, c)) continue;
-                bestR = r; bestC = c; bestScore = 7'000'000;
-                break;
-            }
-            // Если пути нет, перебираем все пустые клетки, которые ломают победу X
-            if (bestR == -1) {
-                for (const auto& cell : emptyCells) {
-                    int r = cell.first, c = cell.second;
-                    game->makeMove(r, c, 'O');
-                    bool stillWin = isXOneMoveFromWin();
-                    game->undoMove(r, c);
-                    if (!stillWin) { bestR = r; bestC = c; bestScore = 6'800'000; break; }
-                }
-            }
-        }
-        // Жёстко перекрываем любой конкретный выигрышный ход X: если X ставит и выигрывает, ставим туда O.
-        if (bestR == -1) {
-            for (const auto& cell : emptyCells) {
-                int r = cell.first, c = cell.second;
-                game->makeMove(r, c, 'X');
-                bool xWinsHere = game->checkWin('X');
-                game->undoMove(r, c);
-                if (xWinsHere) {
-                    bestR = r; bestC = c; bestScore = 7'200'000;
-                    break;
-                }
-            }
-        }
-        // Если на нижней строке есть клетка, после которой X выигрывает, блокируем её немедленно.
-        if (bestR == -1) {
-            for (const auto& cell : emptyCells) {
-                int r = cell.first, c = cell.second;
-                if (r != boardSize - 1) continue;
-                game->makeMove(r, c, 'X');
-                bool xWinBottom = game->checkWin('X');
-                game->undoMove(r, c);
-                if (xWinBottom) {
-                    bestR = r; bestC = c; bestScore = 6'500'000;
-                    break;
-                }
-            }
-        }
-        // Превентивно портим линию X по нижней строке, если там уже много X или путь X короткий.
-        if (bestR == -1) {
-            int bottomX = 0;
-            for (int c = 0; c < boardSize; ++c) {
-                if (boardSnap[boardSize - 1][c] == 'X') bottomX++;
-            }
-            if (bottomX >= boardSize / 3 || threatCost <= 3) {
-                int bestRaise = -1000000000;
-                int bestCenter = 1'000'000;
-                for (const auto& cell : emptyCells) {
-                    int r = cell.first, c = cell.second;
-                    if (r != boardSize - 1) continue;
-                    game->makeMove(r, c, 'O');
-                    int newCost = minMovesForXToWin(nullptr);
-                    game->undoMove(r, c);
-                    int raise = newCost - threatCost;
-                    int centerDist = abs(c - boardSize / 2);
-                    if (raise > bestRaise || (raise == bestRaise && centerDist < bestCenter)) {
-                        bestRaise = raise;
-                        bestCenter = centerDist;
-                        bestR = r; bestC = c;
-                        bestScore = 5'800'000;
-                    }
-                }
-            }
-        }
-        if (threatCost <= 2) {
-            if (threatCost <= 1 && !threatPath.isEmpty()) {
-                bestR = threatPath.front().first;
-                bestC = threatPath.front().second;
-                bestScore = 5'000'000;
-            }
-            int bestRaise = -1;
-            int bestCenter = 1'000'000;
-            int bestRowBias = -1;
-            for (const auto& cell : emptyCells) {
-                int r = cell.first, c = cell.second;
-                game->makeMove(r, c, 'O');
-                int newCost = minMovesForXToWin(nullptr);
-                game->undoMove(r, c);
-                int raise = newCost - threatCost;
-                int centerDist = abs(r - boardSize / 2) + abs(c - boardSize / 2);
-                if (raise > bestRaise ||
-                    (raise == bestRaise && r > bestRowBias) ||
-                    (raise == bestRaise && r == bestRowBias && centerDist < bestCenter)) {
-                    bestRaise = raise;
-                    bestCenter = centerDist;
-                    bestRowBias = r;
-                    bestR = r;
-                    bestC = c;
-                    bestScore = 4'000'000;
-                }
-            }
-        }
-        // Если путь X короткий (<=3), усиливаем перекрытие его минимального пути.
-        if (bestR == -1 && threatCost <= 3 && !threatPath.isEmpty()) {
-            int localBest = -1000000000;
-            for (const auto& cell : threatPath) {
-                int r = cell.first, c = cell.second;
-                if (!game->isCellEmpty(r, c)) continue;
-                game->makeMove(r, c, 'O');
-                int score = evaluateMoveForO(r, c, playerLastR, playerLastC, threatCost, threatPath, oPathCost, oPath);
-                game->undoMove(r, c);
-                if (score > localBest) {
-                    localBest = score;
-                    bestR = r; bestC = c; bestScore = localBest;
-                }
-            }
-        }
-        if (bestR == -1) {
-            // Первый ход ИИ — в центр или в ближайшую точку своего кратчайшего пути.
-            if (aiFirstMove) {
-                int center = boardSize / 2;
-                if (game->isCellEmpty(center, center)) {
-                    bestR = center;
-                    bestC = center;
-                    bestScore = 3'500'000;
-                } else if (!oPath.isEmpty()) {
-                    bestR = oPath.front().first;
-                    bestC = oPath.front().second;
-                    bestScore = 3'400'000;
-                }
-                aiFirstMove = false;
-            }
-            if (bestR == -1) {
-                // Минимакс глубиной 2: O -> X -> оценка
-                auto evalState = [this]() -> int {
-                    int xCost = minMovesForXToWin(nullptr);
-                    int oCost = minMovesForOToWin(nullptr);
-                    int score = 0;
-                    score += (50 - std::min(50, oCost)) * 30000;
-                    score -= (50 - std::min(50, xCost)) * 32000;
-                    return score;
-                };
-                auto buildXCands = [&](QVector<QPair<int,int>>& xs) {
-                    xs.clear();
-                    QVector<std::tuple<int,int,int>> tmp;
-                    for (const auto& cell : emptyCells) {
-                        int r = cell.first, c = cell.second;
-                        int bias = 0;
-                        if (r >= boardSize - 2) bias += 400;
-                        if (r == boardSize - 1) bias += 800;
-                        int centerDist = abs(r - boardSize/2) + abs(c - boardSize/2);
-                        bias -= centerDist * 5;
-                        tmp.append({bias, r, c});
-                    }
-                    std::sort(tmp.begin(), tmp.end(), [](auto a, auto b) { return std::get<0>(a) > std::get<0>(b); });
-                    int lim = std::min<int>(12, tmp.size());
-                    for (int i = 0; i < lim; ++i) xs.append({std::get<1>(tmp[i]), std::get<2>(tmp[i])});
-                };
+    startTurnTimer(QString("Ход %1 (ИИ)").arg(aiPlayer));
+
+    // Поиск идёт в потоке aiThread на копии доски; ответ придёт в onAIMoveReady.
+    cancelAISearch();
+    aiStop = std::make_shared<std::atomic<bool>>(false);
+    aiThinking = true;
+    AIWorker* worker = aiWorker;
+    HexGame snapshot = game;
+    quint64 generation = aiGeneration;
+    AIWorker::StopFlag stop = aiStop;
+    QMetaObject::invokeMethod(aiWorker, [worker, snapshot, generation, stop]() {
+        worker->search(snapshot, generation, stop);
+    }, Qt::QueuedConnection);
+}
 
-                struct MoveScore { int score; int r; int c; };
-                QVector<MoveScore> oCands;
-                for (const auto& cell : oPath) {
-                    if (game->isCellEmpty(cell.first, cell.second))
-                        oCands.append({300, cell.first, cell.second});
-                }
-                for (const auto& cell : emptyCells) {
-                    int r = cell.first, c = cell.second;
-                    int quick = 0;
-                    if (r >= boardSize - 2) quick += 200;
-                    if (r == boardSize - 1) quick += 400;
-                    int centerDist = abs(r - boardSize/2) + abs(c - boardSize/2);
-                    quick -= centerDist * 3;
-                    oCands.append({quick, r, c});
-                }
-                std::sort(oCands.begin(), oCands.end(), [](const MoveScore& a, const MoveScore& b){ return a.score > b.score; });
-                int oLim = std::min<int>(18, oCands.size());
+void MainWindow::onAIMoveReady(quint64 generation, int row, int col) {
+    if (generation != aiGeneration || gameOver) return;
+    aiThinking = false;
+    aiStop.reset();
+    if (row == -1) return;
+    if (turnTimer) turnTimer->stop();
+    board->clearAnalysis();
+    history->play({row, col});
+    updateBoard();
+    if (history->position().checkWin(aiPlayer)) {
+        finishGame(QString("🤖 ПОБЕДИЛ ИИ %1!").arg(aiPlayer));
+        return;
+    }
+    if (history->position().isFull()) {
+        finishGame("НИЧЬЯ!");
+        return;
+    }
+    currentPlayer = opponentOf(aiPlayer);
+    QString msg = QString("Твой ход %1").arg(currentPlayer);
+    printStatus(msg);
+    startTurnTimer(msg);
+    startPondering();
+}
 
-                int globalBest = -2000000000;
-                int chosenR = -1, chosenC = -1;
-                QVector<QPair<int,int>> xCandidates;
+void MainWindow::startPondering() {
+    // Пока думает человек, ИИ продолжает строить дерево в своём потоке.
+    // Размышление останавливается в cancelAISearch — до постановки поиска
+    // в очередь, поэтому поиск начинается сразу после него.
+    ponderStop = std::make_shared<std::atomic<bool>>(false);
+    AIWorker* worker = aiWorker;
+    HexGame snapshot = history->position();
+    AIWorker::StopFlag stop = ponderStop;
+    QMetaObject::invokeMethod(aiWorker, [worker, snapshot, stop]() {
+        worker->ponder(snapshot, stop);
+    }, Qt::QueuedConnection);
+}
 
-                for (int idx = 0; idx < oLim; ++idx) {
-                    int r = oCands[idx].r;
-                    int c = oCands[idx].c;
-                    if (!game->isCellEmpty(r, c)) continue;
-                    game->makeMove(r, c, 'O');
-                    if (game->checkWin('O')) {
-                        game->undoMove(r, c);
-                        bestR = r; bestC = c; bestScore = 100000000;
-                        break;
-                    }
-                    int worstForO = 2000000000;
-                    buildXCands(xCandidates);
-                    if (xCandidates.isEmpty()) {
-                        worstForO = evalState();
-                    } else {
-                        for (const auto& xc : xCandidates) {
-                            int xr = xc.first, xcCol = xc.second;
-                            game->makeMove(xr, xcCol, 'X');
-                            if (game->checkWin('X')) {
-                                worstForO = std::min(worstForO, -100000000);
-                            } else {
-                                int s = evalState();
-                                worstForO = std::min(worstForO, s);
-                            }
-                            game->undoMove(xr, xcCol);
-                        }
-                    }
-                    game->undoMove(r, c);
-                    if (worstForO > globalBest) {
-                        globalBest = worstForO;
-                        chosenR = r; chosenC = c;
-                    }
-                }
+void MainWindow::cancelAISearch() {
+    if (aiStop) aiStop->store(true);
+    aiStop.reset();
+    if (ponderStop) ponderStop->store(true);
+    ponderStop.reset();
+    ++aiGeneration;
+    aiThinking = false;
+    board->clearAnalysis();
+}
 
-                if (bestR == -1 && chosenR != -1) {
-                    bestR = chosenR; bestC = chosenC; bestScore = globalBest;
-                }
-            }
-            if (bestR == -1) {
-                struct MoveScore { int score; int pos; int c; };
-                QVector<MoveScore> topMoves;
-                for (const auto& cell : emptyCells) {
-                    int r = cell.first, c = cell.second;
-                    int quickScore = 0;
-                    if (abs(r - playerLastR) + abs(c - playerLastC) <= 2) quickScore += 1000;
-                    if (r == 0 || r == boardSize-1) quickScore += 500;
-                    topMoves.append({quickScore, r * boardSize + c, c});
-                    game->makeMove(r, c, 'O');
-                    if (game->checkWin('O')) {
-                        bestR = r; bestC = c; bestScore = 5000000;
-                        game->undoMove(r, c);
-                        break;
-                    }
-                    game->undoMove(r, c);
-                }
-                int limit = std::min<int>(20, static_cast<int>(topMoves.size()));
-                for (int i = 0; i < limit; ++i) {
-                    int r = topMoves[i].pos / boardSize;
-                    int c = topMoves[i].pos % boardSize;
-                    game->makeMove(r, c, 'O');
-                    int score = evaluateMoveForO(r, c, playerLastR, playerLastC, threatCost, threatPath, oPathCost, oPath);
-                    game->undoMove(r, c);
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestR = r;
-                        bestC = c;
-                    }
-                }
-            }
-        }
-        if (bestR == -1 && !oPath.isEmpty()) {
-            int localBestScore = -1000000000;
-            for (int i = 0; i < oPath.size(); ++i) {
-                int r = oPath[i].first;
-                int c = oPath[i].second;
-                if (!game->isCellEmpty(r, c)) continue;
-                game->makeMove(r, c, 'O');
-                int score = evaluateMoveForO(r, c, playerLastR, playerLastC, threatCost, threatPath, oPathCost, oPath);
-                game->undoMove(r, c);
-                if (score > localBestScore) {
-                    localBestScore = score;
-                    bestR = r;
-                    bestC = c;
-                }
-            }
-            if (bestR != -1) bestScore = localBestScore;
-        }
-        if (bestR != -1) {
-            game->makeMove(bestR, bestC, 'O');
-            aiFirstMove = false;
-            updateBoard();
-            QString moveMsg;
-            if (xOneMove || xTwoMoves) {
-                moveMsg = QString("🛡️ Блокируем победу X: [%1,%2]").arg(bestR).arg(bestC);
-            } else {
-                moveMsg = QString("🔗 ИИ строит путь: [%1,%2]").arg(bestR).arg(bestC);
-            }
-            if (game->checkWin('O')) {
-                finishGame("🤖 ПОБЕДИЛ ИИ O!");
-                return;
-            }
-            if (game->isFull()) {
-                finishGame("НИЧЬЯ!");
-                return;
-            }
-            currentPlayer = 'X';
-            QString msg = "Твой ход X";
-            printStatus(msg);
-            startTurnTimer(msg);
-        }
-    });
+void MainWindow::setAnalysisEnabled(bool enabled) {
+    aiWorker->setAnalysisEnabled(enabled);
+    analysisLabel->setVisible(enabled);
+    analysisLabel->clear();
+    if (enabled) {
+        analysisTimer->start();
+    } else {
+        analysisTimer->stop();
+        board->clearAnalysis();
+    }
+}
+
+// Снимок поиска забирается из тройного буфера без блокировок: поток ИИ
+// его не ждёт. Снимки прошлых поисков и других позиций отбрасываются.
+void MainWindow::showAnalysis() {
+    AnalysisBuffer& buffer = aiWorker->analysisBuffer();
+    if (!buffer.update() || !aiThinking) return;
+    const AnalysisSnapshot& snap = buffer.readBuffer();
+    if (snap.size != boardSize || snap.hash != history->position().hash()) return;
+
+    const int cells = boardSize * boardSize;
+    uint32_t most = 1;
+    for (int idx = 0; idx < cells; ++idx) most = std::max(most, snap.visits[idx]);
+    std::vector<float> share(cells), winRate(cells);
+    for (int idx = 0; idx < cells; ++idx) {
+        share[idx] = static_cast<float>(snap.visits[idx]) / most;
+        winRate[idx] = snap.winRate[idx];
+    }
+    const std::vector<int> pv(snap.pv, snap.pv + snap.pvLength);
+    board->setAnalysis(share, winRate, pv, snap.toMove);
+
+    QStringList line;
+    for (int cell : pv) line << QString::fromStdString(cellName(cell / boardSize, cell % boardSize));
+    const double best = snap.pvLength > 0 ? snap.winRate[snap.pv[0]] : 0.5;
+    analysisLabel->setText(QString("%1 симуляций/с · победа ИИ %2% · вариант: %3")
+                               .arg(static_cast<qlonglong>(snap.playoutsPerSecond))
+                               .arg(qRound(100.0 * best))
+                               .arg(line.isEmpty() ? QString("—") : line.join(' ')));
 }
 
 void MainWindow::finishGame(const QString& winnerText) {
+    cancelAISearch();
     gameOver = true;
     if (turnTimer) turnTimer->stop();
     printStatus(winnerText);
+    // Партия дописывается строкой в hexgames.txt рядом с программой.
+    appendTextRecord((QCoreApplication::applicationDirPath() + "/hexgames.txt").toStdString(),
+                     GameRecord::fromGame(history->position()));
     QMessageBox box(this);
     box.setWindowTitle("Игра завершена");
     box.setText(winnerText);
@@ -804,7 +366,7 @@ void MainWindow::finishGame(const QString& winnerText) {
 void MainWindow::onCellClicked(int row, int col) {
     if (gameOver) return;
     if (turnTimer) turnTimer->stop();
-    if (currentPlayer != 'X' && vsAI) {
+    if (vsAI && currentPlayer == aiPlayer) {
         startTurnTimer(QString("Ход %1").arg(currentPlayer));
         return;
     }
@@ -812,23 +374,22 @@ void MainWindow::onCellClicked(int row, int col) {
         startTurnTimer(QString("Ход %1").arg(currentPlayer));
         return;
     }
-    if (!game->makeMove(row, col, currentPlayer)) {
+    if (!history->play({row, col})) {
         if (turnTimer) startTurnTimer(QString("Ход %1").arg(currentPlayer));
         return;
     }
     updateBoard();
-    if (currentPlayer == 'X') { lastXRow = row; lastXCol = col; }
-    if (game->checkWin(currentPlayer)) {
+    if (history->position().checkWin(currentPlayer)) {
         finishGame(currentPlayer == 'X' ? "🎉 ПОБЕДИЛ X!" : "🎉 ПОБЕДИЛ O!");
         return;
     }
-    if (game->isFull()) {
+    if (history->position().isFull()) {
         finishGame("НИЧЬЯ!");
         return;
     }
     currentPlayer = (currentPlayer == 'X') ? 'O' : 'X';
-    if (vsAI && currentPlayer == 'O') {
-        triggerAIMove(row, col);
+    if (vsAI && currentPlayer == aiPlayer) {
+        triggerAIMove();
     } else {
         QString msg = QString("Ход %1").arg(currentPlayer);
         printStatus(msg);
@@ -836,91 +397,76 @@ void MainWindow::onCellClicked(int row, int col) {
     }
 }
 
-int MainWindow::evaluateMoveForO(int r, int c, int playerLastR, int playerLastC,
-                                 int baseThreatCost,
-                                 const QVector<QPair<int,int>>& threatPath,
-                                 int baseOPathCost,
-                                 const QVector<QPair<int,int>>& oPath) {
-    const auto &board = game->getBoard();
-    int size = game->getSize();
-    int score = 0;
-    if (game->checkWin('O')) return 5000000;
-    int newThreat = minMovesForXToWin(nullptr);
-    int threatDelta = baseThreatCost - newThreat;
-    if (newThreat <= 1) score += 800000;
-    if (threatDelta > 0) score += threatDelta * 400000;
-    for (const auto& cell : threatPath) {
-        if (cell.first == r && cell.second == c) {
-            score += 180000;
-            break;
-        }
-    }
-    int newOPathCost = minMovesForOToWin(nullptr);
-    int oGain = baseOPathCost - newOPathCost;
-    if (newOPathCost <= 1) score += 700000;
-    if (oGain > 0) score += oGain * 300000;
-    for (const auto& cell : oPath) {
-        if (cell.first == r && cell.second == c) {
-            score += 250000; // бонус за продвижение по своему кратчайшему пути
-            break;
-        }
-    }
-    game->makeMove(r, c, 'X');
-    bool xWinHere = game->checkWin('X');
-    game->undoMove(r, c);
-    if (xWinHere) return 3000000;
-    bool xOneThreat = isXOneMoveFromWin();
-    if (xOneThreat) score += 2500000;
-    else if (isXTwoMovesFromWin()) score += 2000000;
-    int pathScore = shortestPathToConnectO(r, c);
-    score += (size * 3 - pathScore) * 8000;
-    if (r >= size - 2) score += 120000; // агрессивно блокируем низ поля
-    if (playerLastR >= size - 2 && abs(r - playerLastR) <= 1) score += 120000;
-    int distToPlayer = abs(r - playerLastR) + abs(c - playerLastC);
-    if (distToPlayer <= 2) score += (3 - distToPlayer) * 10000;
-    if (c >= size - 3) score += 8000;
-    if (r <= 1 || r >= size - 2) score += 5000;
-    int neighbors = 0;
-    for (int d = 0; d < 6; ++d) {
-        int nr = r + kHexDirections[d][0];
-        int nc = c + kHexDirections[d][1];
-        if (nr >= 0 && nr < size && nc >= 0 && nc < size) {
-            if (board[nr][nc] == 'O') neighbors += 2;
-            if (board[nr][nc] == 'X') neighbors += 1;
-        }
-    }
-    score += neighbors * 1000;
-    int centerDist = abs(r - size/2) + abs(c - size/2);
-    score += (size - centerDist) * 200;
-    return score;
+// Каждый ход меняет одну клетку — последнюю; доска перерисовывает только её.
+void MainWindow::updateBoard() {
+    updateHistoryControls();
+    const HexGame& game = history->position();
+    const int last = game.lastMove();
+    if (last < 0) return;
+    const int r = last / boardSize, c = last % boardSize;
+    board->setCell(r, c, game.getCell(r, c));
 }
 
-void MainWindow::updateBoard() {
-    const auto board = game->getBoard();
+// После перехода по истории меняется любое число клеток; setCell не трогает
+// совпавшие, поэтому перерисовываются только изменившиеся.
+void MainWindow::syncBoard() {
+    const HexGame& game = history->position();
     for (int r = 0; r < boardSize; ++r) {
-        for (int c = 0; c < boardSize; ++c) {
-            QPushButton* btn = buttons[r][c];
-            char cell = board[r][c];
-            if (cell == 'X') {
-                btn->setText("X");
-                btn->setStyleSheet(
-                    "QPushButton { background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #FF8888, stop:1 #CC0000); "
-                    "border: 2px solid #FF4444; border-radius: 24px; font-size: 22px; font-weight: bold; color: white; }");
-            } else if (cell == 'O') {
-                btn->setText("O");
-                btn->setStyleSheet(
-                    "QPushButton { background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #88CCFF, stop:1 #0055CC); "
-                    "border: 2px solid #44AAFF; border-radius: 24px; font-size: 22px; font-weight: bold; color: white; }");
-            } else {
-                btn->setText("");
-                btn->setStyleSheet(
-                    "QPushButton { border: 2px solid #777; border-radius: 24px; "
-                    "background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #DDDDDD, stop:1 #AAAAAA); "
-                    "font-size: 22px; font-weight: bold; }"
-                    "QPushButton:hover { background: qlineargradient(x1:0,y1:0,x2:1,y2:1,stop:0 #EEEEEE, stop:1 #CCCCCC); }");
-            }
-        }
+        for (int c = 0; c < boardSize; ++c) board->setCell(r, c, game.getCell(r, c));
+    }
+}
+
+void MainWindow::updateHistoryControls() {
+    const QSignalBlocker blocker(moveSlider);
+    moveSlider->setRange(0, history->length());
+    moveSlider->setValue(history->ply());
+    moveLabel->setText(QString("%1/%2").arg(history->ply()).arg(history->length()));
+    undoButton->setEnabled(history->canUndo());
+    redoButton->setEnabled(history->canRedo());
+}
+
+void MainWindow::undoMove() {
+    if (!history->undo()) return;
+    // Против ИИ отменяется и его ответ: ход снова за человеком.
+    if (vsAI && sideToMove(history->position()) == aiPlayer && history->canUndo()) history->undo();
+    resumeFromHistory();
+}
+
+void MainWindow::redoMove() {
+    if (!history->redo()) return;
+    const HexGame& game = history->position();
+    const bool finished = game.checkWin('X') || game.checkWin('O');
+    if (vsAI && !finished && sideToMove(game) == aiPlayer && history->canRedo()) history->redo();
+    resumeFromHistory();
+}
+
+void MainWindow::jumpToMove(int ply) {
+    if (ply == history->ply() || !history->jumpTo(ply)) return;
+    resumeFromHistory();
+}
+
+// Партия продолжается с позиции из истории. Поиск ИИ отменяется, но его
+// дерево остаётся: корень возвращается к узлу этой позиции (MctsAI).
+void MainWindow::resumeFromHistory() {
+    cancelAISearch();
+    if (turnTimer) turnTimer->stop();
+    syncBoard();
+    updateHistoryControls();
+    const HexGame& game = history->position();
+    currentPlayer = sideToMove(game);
+    gameOver = game.checkWin('X') || game.checkWin('O');
+    if (gameOver) {
+        printStatus(game.checkWin('X') ? "🎉 ПОБЕДИЛ X!" : "🎉 ПОБЕДИЛ O!");
+        return;
+    }
+    if (vsAI && currentPlayer == aiPlayer) {
+        triggerAIMove();
+        return;
     }
+    const QString msg = vsAI ? QString("Твой ход %1").arg(currentPlayer) : QString("Ход %1").arg(currentPlayer);
+    printStatus(msg);
+    startTurnTimer(msg);
+    if (vsAI) startPondering();
 }
 
 void MainWindow::printStatus(const QString &message) {
@@ -931,7 +477,9 @@ void MainWindow::showMenu() {
     QMessageBox::information(this, "Супер ИИ HEX",
                              "Смысл игры\n"
                              "Гекс (Hex) — соединить противоположные стороны игрового поля непрерывной цепочкой своих фишек, блокируя соперника, который стремится сделать то же самое между своими сторонами, при этом игра не допускает ничьих, развивая стратегическое и логическое мышление, память, моторику и реакцию.\n\n"
-                             "ИИ анализирует угрозы и строит кратчайший путь для O.\n"
-                             "Блокирует победу X, старается выиграть сам.\n"
-                             "Рандомность минимальна, ходы продуманные.");
+                             "ИИ играет за любой цвет и ищет ход деревом Монте-Карло в отдельном потоке.\n"
+                             "Пока ты думаешь, он продолжает анализ твоих ответов.\n"
+                             "Ходы можно отменять (Ctrl+Z), возвращать и листать ползунком.\n"
+                             "«Анализ ИИ» показывает, какие ходы он проверяет: яркость — как часто, цвет — с каким успехом, цифры — ожидаемое продолжение.\n"
+                             "Блокирует твою победу, старается выиграть сам.");
 }
@@ -2,16 +2,22 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QPushButton>
-#include <vector>
+#include <atomic>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
-class HexGame;
+class AIWorker;
+class GameHistory;
+class HexBoardWidget;
+class QCheckBox;
 class QLabel;
-class QGridLayout;
+class QPushButton;
+class QSlider;
+class QThread;
+class QTimer;
 
 class MainWindow : public QMainWindow
 {
@@ -23,6 +29,12 @@ public:
 
 private slots:
     void onCellClicked(int row, int col);
+    void onAIMoveReady(quint64 generation, int row, int col);
+    void undoMove();
+    void redoMove();
+    void jumpToMove(int ply);
+    void setAnalysisEnabled(bool enabled);
+    void showAnalysis();
 
 private:
     void setupUI();
@@ -30,39 +42,42 @@ private:
     void showIntro();
     void showMenu();
     void updateBoard();
+    void syncBoard();
+    void updateHistoryControls();
+    void resumeFromHistory();
     void printStatus(const QString &message);
     void startTurnTimer(const QString& baseStatus);
     void handleTimeout();
-    bool placeRandomMove(char player, int& outR, int& outC);
-    void triggerAIMove(int playerLastR, int playerLastC);
+    bool placeRandomMove(int& outR, int& outC);
+    void triggerAIMove();
+    void cancelAISearch();
+    void startPondering();
     void finishGame(const QString& winnerText);
-    int evaluateMoveForO(int r, int c, int playerLastR, int playerLastC,
-                         int baseThreatCost,
-                         const QVector<QPair<int,int>>& threatPath,
-                         int baseOPathCost,
-                         const QVector<QPair<int,int>>& oPath);
-    int minMovesForXToWin(QVector<QPair<int,int>>* path = nullptr);
-    int minMovesForOToWin(QVector<QPair<int,int>>* path = nullptr);
-
-    // 🆕 НОВЫЕ ФУНКЦИИ ДЛЯ СУПЕР ИИ
-    bool isXOneMoveFromWin();
-    bool isXTwoMovesFromWin();
-    int shortestPathToConnectO(int r, int c);
 
     Ui::MainWindow *ui;
-    HexGame* game;
+    GameHistory* history;                        // ходы партии, позиция — history->position()
     int boardSize;
     char currentPlayer;
     bool vsAI;
+    char aiPlayer;                               // цвет ИИ в игре против человека
     QLabel* statusLabel;
-    QGridLayout* gameGrid;
-    std::vector<std::vector<QPushButton*>> buttons;
-    bool aiFirstMove;
+    QLabel* analysisLabel;                       // скорость поиска, оценка и вариант
+    HexBoardWidget* board;
+    QPushButton* undoButton;
+    QPushButton* redoButton;
+    QSlider* moveSlider;
+    QLabel* moveLabel;
     QTimer* turnTimer;
+    QCheckBox* analysisBox;
+    QTimer* analysisTimer;                       // опрос снимков поиска, 10 раз в секунду
     int remainingSeconds;
-    int lastXRow;
-    int lastXCol;
     bool gameOver;
+    QThread* aiThread;
+    AIWorker* aiWorker;
+    quint64 aiGeneration;                        // ответы прошлых поисков отбрасываются
+    std::shared_ptr<std::atomic<bool>> aiStop;   // флаг остановки текущего поиска
+    std::shared_ptr<std::atomic<bool>> ponderStop;
+    bool aiThinking;
 };
 
 #endif // MAINWINDOW_H
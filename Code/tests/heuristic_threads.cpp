@@ -0,0 +1,54 @@
+// Пакетная оценка HeuristicAI::evaluateMoves должна давать одни и те же
+// оценки в одном и в нескольких потоках: потоки делят ходы, но не поля
+// расстояний. Случайные позиции 11x11, все пустые клетки — кандидаты.
+
+#include "hexcore/heuristicai.h"
+#include "hexcore/hexgame.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main() {
+    constexpr int kPositions = 200;
+    constexpr int kSize = 11;
+    constexpr int kThreads = 4;
+    std::mt19937_64 rng(17);
+    int mismatches = 0;
+    for (int p = 0; p < kPositions; ++p) {
+        HexGame game(kSize);
+        char toMove = 'X';
+        const int stones = static_cast<int>(rng() % 40);
+        for (int k = 0; k < stones; ++k) {
+            std::vector<int> empties;
+            game.emptyCells().forEach([&](int idx) { empties.push_back(idx); });
+            const int idx = empties[rng() % empties.size()];
+            game.makeMove(idx / kSize, idx % kSize, toMove);
+            if (game.checkWin(toMove)) {
+                game.undoMove(idx / kSize, idx % kSize);
+                break;
+            }
+            toMove = opponentOf(toMove);
+        }
+
+        HeuristicAI::MoveContext context;
+        const int last = game.lastMove();
+        if (last >= 0) {
+            context.opponentLastR = last / kSize;
+            context.opponentLastC = last % kSize;
+        }
+        context.threatCost = HeuristicAI::minMovesToWin(game, opponentOf(toMove), &context.threatPath);
+        context.ownPathCost = HeuristicAI::minMovesToWin(game, toMove, &context.ownPath);
+        CellPath moves;
+        game.emptyCells().forEach([&](int idx) { moves.push_back({idx / kSize, idx % kSize}); });
+
+        const std::vector<int> single = HeuristicAI::evaluateMoves(game, toMove, moves, context, 1);
+        const std::vector<int> parallel = HeuristicAI::evaluateMoves(game, toMove, moves, context, kThreads);
+        if (single != parallel) {
+            ++mismatches;
+            std::fprintf(stderr, "position %d: %d-thread scores differ from 1-thread scores\n", p, kThreads);
+        }
+    }
+    std::printf("%d positions, %d mismatches\n", kPositions, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
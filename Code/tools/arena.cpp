@@ -0,0 +1,240 @@
+// Матч двух движков без окна: N партий параллельно на пуле потоков,
+// доля побед с доверительным интервалом, время на ход и партий в секунду.
+//
+//   hex_arena [опции] движокA движокB
+//   hex_arena --games 200 --size 9 mcts:300 smarter:4:100
+//
+// Движки: random, heuristic, smarter[:глубина[:мс]], mcts[:мс].
+// Партии идут парами с одинаковым случайным дебютом и сменой цветов.
+// --book подключает дебютную книгу обоим движкам, --book-a — только движку A;
+// --swap включает правило обмена; --record сохраняет партии в файл партий
+// (gamerecord.h) для книги и настройки движков; --positions добавляет
+// позиции партий в базу позиций (positiondb.h), создавая её при нужде.
+
+#include "hexcore/engine.h"
+#include "hexcore/gamerecord.h"
+#include "hexcore/hexgame.h"
+#include "hexcore/openingbook.h"
+#include "hexcore/positiondb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int games = 100;
+    int size = 11;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int openingPlies = 1;
+    uint64_t seed = 1;
+    bool swapRule = false;
+    std::string engines[2];
+    std::shared_ptr<const OpeningBook> books[2];
+    GameWriter* record = nullptr;
+    std::mutex* recordMutex = nullptr;
+    PositionDB* positions = nullptr;       // пишется без блокировки
+};
+
+struct Totals {
+    int wins[2] = {};           // по движкам A и B
+    int xWins = 0;
+    int illegal[2] = {};
+    long moves[2] = {};
+    double seconds[2] = {};
+    long droppedPositions = 0;  // не поместились в базу позиций
+};
+
+// Одна партия: в паре партий A и B по очереди играют за X.
+void playGame(const Options& opt, int gameIndex, Totals& local) {
+    const int pair = gameIndex / 2;
+    const int xSide = gameIndex % 2;
+    std::mt19937_64 openingRng(opt.seed * 0x9E3779B97F4A7C15ull + pair);
+
+    HexGame game(opt.size, opt.swapRule);
+    const int N = game.getSize();
+    char toMove = 'X';
+    for (int ply = 0; ply < opt.openingPlies && !game.isFull(); ++ply) {
+        std::vector<int> empties;
+        game.emptyCells().forEach([&](int idx) { empties.push_back(idx); });
+        int idx = empties[openingRng() % empties.size()];
+        game.makeMove(idx / N, idx % N, toMove);
+        toMove = opponentOf(toMove);
+    }
+
+    std::unique_ptr<Engine> engines[2];
+    for (int side = 0; side < 2; ++side) {
+        engines[side] = makeEngine(opt.engines[side], opt.seed ^ (uint64_t(gameIndex) << 1 | side));
+        if (opt.books[side]) engines[side] = std::make_unique<BookEngine>(std::move(engines[side]), opt.books[side]);
+    }
+    SearchLimits limits;
+    limits.threads = 1;   // параллельны партии, а не поиск
+
+    int winner = -1;
+    while (winner < 0) {
+        const int side = toMove == 'X' ? xSide : 1 - xSide;
+        auto start = std::chrono::steady_clock::now();
+        Move move = engines[side]->think(game, limits);
+        local.seconds[side] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++local.moves[side];
+        if (!applyMove(game, move)) {
+            ++local.illegal[side];
+            winner = 1 - side;
+            break;
+        }
+        if (game.checkWin(toMove)) winner = side;
+        toMove = opponentOf(toMove);
+    }
+    ++local.wins[winner];
+    if (winner == xSide) ++local.xWins;
+    if (opt.record || opt.positions) {
+        // Проигрыш за невозможный ход на доске не виден, победитель — из матча.
+        GameRecord record = GameRecord::fromGame(game);
+        record.winner = winner == xSide ? 'X' : 'O';
+        if (opt.positions) local.droppedPositions += opt.positions->addGame(record);
+        if (opt.record) {
+            std::lock_guard<std::mutex> lock(*opt.recordMutex);
+            opt.record->write(record);
+        }
+    }
+}
+
+// Интервал Уилсона для доли побед, z = 1.96 (95%).
+void wilson(int wins, int games, double& low, double& high) {
+    const double z = 1.96;
+    if (games == 0) {
+        low = 0.0;
+        high = 1.0;
+        return;
+    }
+    double p = static_cast<double>(wins) / games;
+    double denom = 1.0 + z * z / games;
+    double center = (p + z * z / (2.0 * games)) / denom;
+    double margin = z * std::sqrt(p * (1.0 - p) / games + z * z / (4.0 * games * games)) / denom;
+    low = std::max(0.0, center - margin);
+    high = std::min(1.0, center + margin);
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: hex_arena [--games N] [--size N] [--threads N] [--opening PLIES] [--seed S]\n"
+                 "                 [--book FILE] [--book-a FILE] [--swap] [--record FILE]\n"
+                 "                 [--positions FILE] A B\n"
+                 "engines: random, heuristic, smarter[:depth[:ms]], mcts[:ms]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    GameWriter record;
+    std::mutex recordMutex;
+    PositionDB positions;
+    int engineCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) opt.games = std::atoi(argv[++i]);
+        else if (arg == "--size" && hasValue) opt.size = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opt.threads = std::atoi(argv[++i]);
+        else if (arg == "--opening" && hasValue) opt.openingPlies = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if ((arg == "--book" || arg == "--book-a") && hasValue) {
+            auto book = std::make_shared<OpeningBook>();
+            if (!book->open(argv[++i])) {
+                std::fprintf(stderr, "cannot open book %s\n", argv[i]);
+                return 2;
+            }
+            opt.books[0] = book;
+            if (arg == "--book") opt.books[1] = book;
+        }
+        else if (arg == "--swap") opt.swapRule = true;
+        else if (arg == "--record" && hasValue) {
+            if (!record.open(argv[++i])) {
+                std::fprintf(stderr, "cannot write %s\n", argv[i]);
+                return 2;
+            }
+            opt.record = &record;
+            opt.recordMutex = &recordMutex;
+        }
+        else if (arg == "--positions" && hasValue) {
+            const char* path = argv[++i];
+            // Существующий файл не перезаписывается, даже если это не база.
+            const bool ready = positions.open(path, true) ||
+                               (!std::ifstream(path) && PositionDB::create(path) && positions.open(path, true));
+            if (!ready) {
+                std::fprintf(stderr, "cannot open position database %s\n", path);
+                return 2;
+            }
+            opt.positions = &positions;
+        }
+        else if (engineCount < 2 && makeEngine(arg)) opt.engines[engineCount++] = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (engineCount != 2 || opt.games < 1 || opt.size < 2 || opt.size > kMaxBoardSize) {
+        usage();
+        return 2;
+    }
+    opt.threads = std::max(1, std::min(opt.threads, opt.games));
+    opt.openingPlies = std::max(0, std::min(opt.openingPlies, opt.size * opt.size - 1));
+
+    std::printf("%s vs %s, size %d, %d games, %d threads\n", opt.engines[0].c_str(),
+                opt.engines[1].c_str(), opt.size, opt.games, opt.threads);
+
+    Totals totals;
+    std::mutex totalsMutex;
+    std::atomic<int> nextGame{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < opt.threads; ++t) {
+        pool.emplace_back([&] {
+            Totals local;
+            for (int g = nextGame++; g < opt.games; g = nextGame++) playGame(opt, g, local);
+            std::lock_guard<std::mutex> lock(totalsMutex);
+            for (int side = 0; side < 2; ++side) {
+                totals.wins[side] += local.wins[side];
+                totals.illegal[side] += local.illegal[side];
+                totals.moves[side] += local.moves[side];
+                totals.seconds[side] += local.seconds[side];
+            }
+            totals.xWins += local.xWins;
+            totals.droppedPositions += local.droppedPositions;
+        });
+    }
+    for (auto& th : pool) th.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int side = 0; side < 2; ++side) {
+        double low, high;
+        wilson(totals.wins[side], opt.games, low, high);
+        double msPerMove = totals.moves[side] ? 1000.0 * totals.seconds[side] / totals.moves[side] : 0.0;
+        std::printf("%-20s wins %4d/%d  %5.1f%%  95%% CI [%5.1f%%, %5.1f%%]  %8.2f ms/move",
+                    opt.engines[side].c_str(), totals.wins[side], opt.games,
+                    100.0 * totals.wins[side] / opt.games, 100.0 * low, 100.0 * high, msPerMove);
+        if (totals.illegal[side]) std::printf("  illegal moves: %d", totals.illegal[side]);
+        std::printf("\n");
+    }
+    std::printf("X wins %d/%d (%.1f%%), %.2f games/s, %.1f s total\n", totals.xWins, opt.games,
+                100.0 * totals.xWins / opt.games, opt.games / elapsed, elapsed);
+    if (opt.positions) {
+        std::printf("positions: %zu of %zu slots used", positions.size(), positions.capacity());
+        if (totals.droppedPositions) std::printf(", %ld dropped (database full)", totals.droppedPositions);
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+// Замеры горячих путей доски и движков на досках 7, 11 и 19. Позиции
+// строятся из фиксированного зерна, поэтому числа сравнимы между сборками.
+//
+//   hex_bench --benchmark_filter=MakeUndo
+
+#include "hexcore/engine.h"
+#include "hexcore/evaluator.h"
+#include "hexcore/heuristicai.h"
+#include "hexcore/hexgame.h"
+#include "hexcore/hsearch.h"
+#include "hexcore/inferior.h"
+#include "hexcore/mctsai.h"
+#include "hexcore/smarterai.h"
+#include "tools/heapcount.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Позиция с заполненной третью доски без победителя; ход за O.
+HexGame randomPosition(int size, uint32_t seed = 12345) {
+    std::mt19937 rng(seed + size);
+    while (true) {
+        HexGame game(size);
+        const int N = game.getSize();
+        const int stones = (N * N / 3) & ~1;
+        char toMove = 'X';
+        for (int k = 0; k <= stones; ++k) {
+            int idx;
+            do {
+                idx = static_cast<int>(rng() % (N * N));
+            } while (!game.isCellEmpty(idx / N, idx % N));
+            game.makeMove(idx / N, idx % N, toMove);
+            toMove = opponentOf(toMove);
+        }
+        if (!game.checkWin('X') && !game.checkWin('O')) return game;
+    }
+}
+
+std::vector<int> emptyList(const HexGame& game) {
+    std::vector<int> cells;
+    game.emptyCells().forEach([&](int idx) { cells.push_back(idx); });
+    return cells;
+}
+
+void BM_CheckWin(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(game.checkWin('X'));
+        benchmark::DoNotOptimize(game.checkWin('O'));
+    }
+}
+
+void BM_IsFull(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(game.isFull());
+}
+
+void BM_MakeUndo(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    const int N = game.getSize();
+    const std::vector<int> cells = emptyList(game);
+    size_t i = 0;
+    for (auto _ : state) {
+        int idx = cells[i];
+        game.makeMove(idx / N, idx % N, 'O');
+        game.undoMove(idx / N, idx % N);
+        if (++i == cells.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MinMovesToWin(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(HeuristicAI::minMovesToWin(game, 'X'));
+}
+
+// Ход и откат с инкрементальным обновлением расстояний обоих игроков.
+void BM_EvaluatorPlayUndo(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    const int N = game.getSize();
+    const std::vector<int> cells = emptyList(game);
+    HexEvaluator eval;
+    eval.reset(game);
+    size_t i = 0;
+    for (auto _ : state) {
+        int idx = cells[i];
+        game.makeMove(idx / N, idx % N, 'O');
+        eval.play(game);
+        benchmark::DoNotOptimize(eval.shortestPath(game, 'X'));
+        game.undoMove(idx / N, idx % N);
+        eval.undo();
+        if (++i == cells.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TwoDistance(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    HexEvaluator eval;
+    for (auto _ : state) benchmark::DoNotOptimize(eval.twoDistance(game, 'O'));
+}
+
+// Мёртвые, захваченные и подчинённые клетки с заполнением до неподвижной точки.
+void BM_InferiorCells(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(findInferiorCells(game));
+}
+
+void BM_EvaluateMove(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    const int N = game.getSize();
+    const int last = game.lastMove();
+    CellPath threatPath;
+    CellPath ownPath;
+    const int threatCost = HeuristicAI::minMovesToWin(game, 'X', &threatPath);
+    const int ownCost = HeuristicAI::minMovesToWin(game, 'O', &ownPath);
+    const std::vector<int> cells = emptyList(game);
+    size_t i = 0;
+    for (auto _ : state) {
+        int idx = cells[i];
+        game.makeMove(idx / N, idx % N, 'O');
+        benchmark::DoNotOptimize(HeuristicAI::evaluateMove(game, 'O', idx / N, idx % N, last / N, last % N,
+                                                           threatCost, threatPath, ownCost, ownPath));
+        game.undoMove(idx / N, idx % N);
+        if (++i == cells.size()) i = 0;
+    }
+}
+
+// Все пустые клетки одним пакетом: поля считаются один раз на пакет.
+void BM_EvaluateMoves(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    const int N = game.getSize();
+    HeuristicAI::MoveContext context;
+    context.opponentLastR = game.lastMove() / N;
+    context.opponentLastC = game.lastMove() % N;
+    context.threatCost = HeuristicAI::minMovesToWin(game, 'X', &context.threatPath);
+    context.ownPathCost = HeuristicAI::minMovesToWin(game, 'O', &context.ownPath);
+    CellPath moves;
+    for (int idx : emptyList(game)) moves.push_back({idx / N, idx % N});
+    for (auto _ : state) benchmark::DoNotOptimize(HeuristicAI::evaluateMoves(game, 'O', moves, context));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(moves.size()));
+}
+
+void BM_HeuristicChooseMove(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    HeuristicAI ai;
+    for (auto _ : state) benchmark::DoNotOptimize(ai.chooseMove(game));
+}
+
+// Полный поиск на глубину 2 с чистой таблицей транспозиций на каждом ходе,
+// без решателя.
+void BM_SmarterChooseMove(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        state.PauseTiming();
+        SmarterAI ai('O', 2);
+        ai.setSolverMs(0);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(ai.chooseMove(game));
+    }
+}
+
+// Симуляция как в MctsAI: случайное распределение пустых клеток и один
+// обход камней X на полной доске.
+void BM_RandomPlayout(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    std::vector<int> cells = emptyList(game);
+    const int xCount = static_cast<int>(cells.size() + 1) / 2;
+    std::mt19937 rng(7);
+    for (auto _ : state) {
+        Bitboard xStones = game.stonesOf('X');
+        for (int i = 0; i < xCount; ++i) {
+            int j = i + static_cast<int>(rng() % (cells.size() - i));
+            std::swap(cells[i], cells[j]);
+            xStones.set(cells[i]);
+        }
+        benchmark::DoNotOptimize(winnerOnFullBoard(game.geometry(), xStones));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Симуляция по шаблонам: ответы на вторжения в мосты и веса окрестности.
+void BM_PatternPlayout(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    uint64_t rng = 7;
+    for (auto _ : state) benchmark::DoNotOptimize(patternPlayout(game, 'O', rng));
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Весь цикл MCTS на 2000 симуляций в одном потоке без решателя: спуск,
+// раскрытие, симуляция и обратный проход.
+void BM_MctsSearch(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    MctsLimits limits;
+    limits.timeMs = 0;
+    limits.maxPlayouts = 2000;
+    limits.nodeCapacity = 1 << 18;
+    limits.solverMs = 0;
+    MctsAI ai('O', limits);
+    long playouts = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ai.chooseMove(game));
+        playouts += ai.lastStats().playouts;
+        state.PauseTiming();
+        ai.clearTree();
+        state.ResumeTiming();
+    }
+    state.counters["playouts/s"] = benchmark::Counter(static_cast<double>(playouts), benchmark::Counter::kIsRate);
+}
+
+// H-search обоих игроков до вывода или исчерпания бюджета; кэш
+// сбрасывается, чтобы каждый замер считал заново.
+void BM_VcSolve(benchmark::State& state) {
+    HexGame game = randomPosition(static_cast<int>(state.range(0)));
+    SolverLimits limits;
+    limits.timeMs = 1000;
+    VcSolver solver(limits);
+    size_t connections = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(solver.solve(game));
+        connections += solver.lastStats().connections;
+        solver.clearCache();
+    }
+    state.counters["connections"] =
+        benchmark::Counter(static_cast<double>(connections), benchmark::Counter::kAvgIterations);
+}
+// Выделения памяти за ход движка в партии после нескольких ходов разогрева;
+// законченная партия начинается заново с той же позиции.
+void BM_ThinkAllocations(benchmark::State& state, const char* spec) {
+    const HexGame start = randomPosition(static_cast<int>(state.range(0)));
+    std::unique_ptr<Engine> engine = makeEngine(spec, 1);
+    HexGame game = start;
+    auto advance = [&] {
+        applyMove(game, engine->think(game, SearchLimits()));
+        if (game.checkWin('X') || game.checkWin('O') || game.isFull()) game = start;
+    };
+    for (int k = 0; k < 4; ++k) advance();
+    const long before = heapAllocations();
+    for (auto _ : state) advance();
+    state.counters["allocs/move"] = benchmark::Counter(static_cast<double>(heapAllocations() - before),
+                                                       benchmark::Counter::kAvgIterations);
+}
+
+} // namespace
+
+BENCHMARK(BM_CheckWin)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_IsFull)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_MakeUndo)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_MinMovesToWin)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_EvaluatorPlayUndo)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_TwoDistance)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_InferiorCells)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_EvaluateMove)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_EvaluateMoves)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_HeuristicChooseMove)->Arg(7)->Arg(11)->Arg(19)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SmarterChooseMove)->Arg(7)->Arg(11)->Arg(19)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandomPlayout)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_PatternPlayout)->Arg(7)->Arg(11)->Arg(19);
+BENCHMARK(BM_MctsSearch)->Arg(7)->Arg(11)->Arg(19)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VcSolve)->Arg(7)->Arg(11)->Arg(19)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ThinkAllocations, heuristic, "heuristic")->Arg(11)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ThinkAllocations, smarter, "smarter:2")->Arg(11)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ThinkAllocations, mcts, "mcts:20")->Arg(11)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
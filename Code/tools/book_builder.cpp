@@ -0,0 +1,190 @@
+// Построение дебютной книги: MCTS оценивает позиции, где ход за книгой,
+// на все ответы соперника, пока не исчерпана глубина в ходах книги.
+// Позиции, совпадающие с точностью до поворота на 180°, считаются один раз.
+//
+//   hex_book [--size N] [--plies D] [--ms T] [--threads K] [--swap] [--merge]
+//            [--games FILE] [--out FILE]
+//   hex_book --size 11 --plies 2 --ms 500 --swap --out hexbook.bin
+//
+// С --swap книга строится для игры с правилом обмена: для каждого первого
+// хода X решается, выгоднее ли O забрать его себе. С --merge записи
+// добавляются к существующему файлу, например для другого размера доски.
+// --games добавляет позиции первых 2·D ходов сыгранных партий из файла
+// партий (hex_arena --record) того же размера и правила обмена.
+
+#include "hexcore/engine.h"
+#include "hexcore/gamerecord.h"
+#include "hexcore/hexgame.h"
+#include "hexcore/mctsai.h"
+#include "hexcore/openingbook.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int size = 11;
+    int plies = 1;
+    int timeMs = 1000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool swapRule = false;
+    bool merge = false;
+    std::string games;
+    std::string out = "hexbook.bin";
+};
+
+class BookBuilder {
+public:
+    explicit BookBuilder(const Options& opt) : opt(opt), ai('X', limitsFor(opt)) {}
+
+    // Ход книги в позиции; при оставшейся глубине — все ответы соперника.
+    void bookPosition(const HexGame& game, int plies) {
+        if (game.checkWin('X') || game.checkWin('O') || game.isFull()) return;
+        if (!seen.insert(bookKey(game)).second) return;
+
+        HexGame work = game;
+        Move move = ai.think(work, SearchLimits());
+        if (!move.isValid()) return;
+        double winRate = ai.lastStats().winRate;
+        // После обмена O получает позицию X, поэтому обмен выгоден, когда
+        // лучший обычный ответ O проигрывает чаще, чем выигрывает.
+        if (game.canSwap() && winRate < 0.5) {
+            move = Move::swapMove();
+            winRate = 1.0 - winRate;
+        }
+
+        BookEntry entry;
+        entry.key = bookKey(game);
+        entry.score = static_cast<int16_t>(winRate * 1000.0 + 0.5);
+        entry.visits = static_cast<uint32_t>(ai.lastStats().playouts);
+        if (move.swap) {
+            entry.move = kBookSwap;
+        } else {
+            const int N = game.getSize();
+            int cell = move.row * N + move.col;
+            if (game.canonicalRotated()) cell = N * N - 1 - cell;
+            entry.move = static_cast<int16_t>(cell);
+        }
+        entries.push_back(entry);
+        if (entries.size() % 50 == 0) {
+            std::fprintf(stderr, "%zu positions, %.0f s\n", entries.size(), secondsSinceStart());
+        }
+
+        if (plies > 1) {
+            applyMove(work, move);
+            expandReplies(work, plies - 1);
+        }
+    }
+
+    // Все ходы стороны, которая ходит, и ход книги в ответ на каждый.
+    void expandReplies(const HexGame& game, int plies) {
+        if (game.checkWin('X') || game.checkWin('O')) return;
+        const int N = game.getSize();
+        const char toMove = sideToMove(game);
+        game.emptyCells().forEach([&](int idx) {
+            HexGame child = game;
+            child.makeMove(idx / N, idx % N, toMove);
+            bookPosition(child, plies);
+        });
+    }
+
+    // Позиции сыгранных партий; файл читается по одной партии.
+    bool bookGames(const std::string& path, int plies) {
+        GameReader reader;
+        if (!reader.open(path)) return false;
+        GameRecord record;
+        while (reader.next(record)) {
+            if (record.size != opt.size || record.swapRule != opt.swapRule) continue;
+            HexGame game(opt.size, opt.swapRule);
+            for (size_t k = 0; k < record.moves.size() && k < static_cast<size_t>(plies); ++k) {
+                bookPosition(game, 1);
+                if (!applyMove(game, record.moves[k])) break;
+            }
+        }
+        return !reader.failed();
+    }
+
+    std::vector<BookEntry>& result() { return entries; }
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    static MctsLimits limitsFor(const Options& opt) {
+        MctsLimits limits;
+        limits.timeMs = opt.timeMs;
+        limits.manageTime = false;   // у каждой позиции книги одинаковый бюджет
+        limits.threads = opt.threads;
+        return limits;
+    }
+
+    const Options& opt;
+    MctsAI ai;
+    std::unordered_set<uint64_t> seen;
+    std::vector<BookEntry> entries;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: hex_book [--size N] [--plies D] [--ms T] [--threads K] [--swap] [--merge]\n"
+                 "                [--games FILE] [--out FILE]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) opt.size = std::atoi(argv[++i]);
+        else if (arg == "--plies" && hasValue) opt.plies = std::atoi(argv[++i]);
+        else if (arg == "--ms" && hasValue) opt.timeMs = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opt.threads = std::atoi(argv[++i]);
+        else if (arg == "--out" && hasValue) opt.out = argv[++i];
+        else if (arg == "--games" && hasValue) opt.games = argv[++i];
+        else if (arg == "--swap") opt.swapRule = true;
+        else if (arg == "--merge") opt.merge = true;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (opt.size < 2 || opt.size > kMaxBoardSize || opt.plies < 1 || opt.timeMs < 1) {
+        usage();
+        return 2;
+    }
+
+    BookBuilder builder(opt);
+    HexGame empty(opt.size, opt.swapRule);
+    // Книга за X начинается с пустой доски, книга за O — с каждого первого хода X.
+    builder.bookPosition(empty, opt.plies);
+    builder.expandReplies(empty, opt.plies);
+    if (!opt.games.empty() && !builder.bookGames(opt.games, 2 * opt.plies)) {
+        std::fprintf(stderr, "cannot read games from %s\n", opt.games.c_str());
+        return 1;
+    }
+
+    std::vector<BookEntry>& entries = builder.result();
+    const size_t built = entries.size();
+    if (opt.merge) {
+        OpeningBook old;
+        if (old.open(opt.out)) entries.insert(entries.end(), old.data(), old.data() + old.size());
+    }
+    if (!OpeningBook::write(opt.out, entries)) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out.c_str());
+        return 1;
+    }
+    std::printf("%zu positions for size %d in %.1f s, %s\n", built, opt.size, builder.secondsSinceStart(),
+                opt.out.c_str());
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Счётчик выделений памяти для hex_bench. Заменён весь набор глобальных
+// new/delete (массивы, выравнивание, nothrow), иначе часть выделений прошла
+// бы мимо счётчика, а освобождение - мимо своей пары. Замены живут в
+// отдельной единице трансляции: встроенный в место вызова delete с free()
+// внутри GCC принимает за несовпадающую пару (-Wmismatched-new-delete).
+
+#include "tools/heapcount.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<long> heapAllocationCount{0};
+
+void* countedAlloc(std::size_t bytes) noexcept {
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(bytes ? bytes : 1);
+}
+
+void* countedAlignedAlloc(std::size_t bytes, std::align_val_t align) noexcept {
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t alignment = static_cast<std::size_t>(align);
+#ifdef _WIN32
+    return _aligned_malloc(bytes ? bytes : 1, alignment);
+#else
+    // aligned_alloc требует размер, кратный выравниванию.
+    const std::size_t rounded = ((bytes ? bytes : 1) + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded);
+#endif
+}
+
+void alignedFree(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t bytes) {
+    if (void* p = countedAlloc(bytes)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes) {
+    if (void* p = countedAlloc(bytes)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+    return countedAlloc(bytes);
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept {
+    return countedAlloc(bytes);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(bytes, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(bytes, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(bytes, align);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(bytes, align);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+
+long heapAllocations() {
+    return heapAllocationCount.load(std::memory_order_relaxed);
+}
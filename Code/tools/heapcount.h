@@ -0,0 +1,8 @@
+#ifndef HEX_TOOLS_HEAPCOUNT_H
+#define HEX_TOOLS_HEAPCOUNT_H
+
+// Число выделений памяти через глобальные operator new с начала процесса.
+// Подключение heapcount.cpp к цели заменяет весь набор new/delete.
+long heapAllocations();
+
+#endif // HEX_TOOLS_HEAPCOUNT_H
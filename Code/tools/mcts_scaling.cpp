@@ -0,0 +1,45 @@
+// Замер масштабирования MCTS по потокам: симуляций в секунду из пустой
+// позиции для каждого режима параллелизма и числа потоков.
+//
+//   hex_mcts_scaling [время_мс] [макс_потоков] [размеры...]
+//   hex_mcts_scaling 2000 16 11 13
+
+#include "hexcore/mctsai.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    int timeMs = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads < 1) maxThreads = 1;
+    std::vector<int> sizes;
+    for (int i = 3; i < argc; ++i) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {11, 13};
+
+    std::printf("%-5s %-5s %7s %14s %10s %12s\n", "size", "mode", "threads", "playouts/s", "speedup", "per thread");
+    for (int size : sizes) {
+        for (MctsParallelMode mode : {kParallelRoot, kParallelTree}) {
+            double base = 0.0;
+            for (int threads = 1; threads <= maxThreads; threads *= 2) {
+                MctsLimits limits;
+                limits.timeMs = timeMs;
+                limits.manageTime = false;   // меряется скорость за всё время
+                limits.threads = threads;
+                limits.parallel = mode;
+                MctsAI ai('X', limits);
+                HexGame game(size);
+                ai.chooseMove(game);
+                double rate = ai.lastStats().playoutsPerSecond();
+                if (threads == 1) base = rate;
+                std::printf("%-5d %-5s %7d %14.0f %9.2fx %12.0f\n", size,
+                            mode == kParallelRoot ? "root" : "tree", threads, rate,
+                            base > 0.0 ? rate / base : 0.0, rate / threads);
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
@@ -271,13 +271,40 @@ def apply_move(state_tup, move_idx, player):
     return tuple(st)
 
 
-def random_playout(state_tup, player_to_move):
+# Соседи по кругу: соседние в списке клетки сами смежны.
+RING_DIRS = ((-1, 0), (-1, 1), (0, 1), (1, 0), (1, -1), (0, -1))
+
+
+def bridge_reply(board, mv, player):
+    # Соперник встал в общую клетку моста игрока: ответ — во вторую.
+    r, c = rc_of(mv)
+    ring = []
+    for dr, dc in RING_DIRS:
+        rr, cc = r + dr, c + dc
+        ring.append(idx_of(rr, cc) if 0 <= rr < N and 0 <= cc < N else None)
+    for d in range(6):
+        a, mid, b = ring[d], ring[(d + 1) % 6], ring[(d + 2) % 6]
+        if a is None or mid is None or b is None:
+            continue
+        if board[a] == player and board[b] == player and board[mid] == EMPTY:
+            return mid
+    return None
+
+
+def random_playout(state_tup, player_to_move, last_move=None):
     board = list(state_tup)
     empties = [i for i, v in enumerate(board) if v == EMPTY]
     random.shuffle(empties)
     p = player_to_move
-    for mv in empties:
+    i = 0
+    for _ in range(len(empties)):
+        mv = bridge_reply(board, last_move, p) if last_move is not None else None
+        if mv is None:
+            while board[empties[i]] != EMPTY:
+                i += 1
+            mv = empties[i]
         board[mv] = p
+        last_move = mv
         p = other(p)
     return winner_on_full(board)
 
@@ -309,7 +336,7 @@ def mcts_best_move(state_tup, player_to_move, time_limit=1.0, exploration_c=1.4)
             p_to_move = node.player_to_move
 
         # Simulation
-        w = random_playout(state, p_to_move)
+        w = random_playout(state, p_to_move, node.move)
 
         # Backprop
         while node is not None: